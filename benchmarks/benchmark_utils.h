@@ -0,0 +1,33 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-01.
+//
+
+#ifndef MATRIX_BENCHMARK_UTILS_H
+#define MATRIX_BENCHMARK_UTILS_H
+
+#include <chrono>
+
+// Runs f repeatedly for at least minMilliseconds and returns the average time of one run in microseconds
+template<typename F>
+double measureMicroseconds(F f, double minMilliseconds = 200) {
+    typedef std::chrono::steady_clock Clock;
+
+    size_t runs = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do {
+        f();
+        runs++;
+        elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    } while (elapsed < minMilliseconds * 1000);
+
+    return elapsed / runs;
+}
+
+// Prevents the compiler from optimizing away a computed value
+template<typename T>
+void doNotOptimize(const T &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+#endif //MATRIX_BENCHMARK_UTILS_H
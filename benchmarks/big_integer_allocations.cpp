@@ -0,0 +1,137 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-11.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include "../include/Rational.h"
+#include "benchmark_utils.h"
+
+static size_t allocationCount = 0;
+
+void *operator new(size_t size) {
+    allocationCount++;
+    if (void *p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+// Prints heap allocations per operation and time per operation
+template<typename F>
+void report(const char *name, size_t operations, F f) {
+    size_t before = allocationCount;
+    f();
+    double allocations = double(allocationCount - before) / operations;
+    double time = measureMicroseconds(f, 100) * 1000 / operations;
+    printf("%-32s %14.2f %12.1f\n", name, allocations, time);
+}
+
+int main() {
+    const size_t n = 100'000;
+    std::mt19937 rnd;
+    std::vector<int> small(n);
+    for (int &x : small) {
+        x = int(rnd() % 2'000'000'000) - 1'000'000'000;
+    }
+
+    printf("%-32s %14s %12s\n", "operation", "allocations", "ns");
+
+    report("BigInteger(int)", n, [&]() {
+        for (int x : small) {
+            BigInteger a(x);
+            doNotOptimize(a);
+        }
+    });
+
+    report("++a", n, [&]() {
+        BigInteger a(0);
+        for (size_t i = 0; i < n; i++) {
+            ++a;
+        }
+        doNotOptimize(a);
+    });
+
+    report("a + b", n, [&]() {
+        BigInteger a(1);
+        for (int x : small) {
+            a = a + BigInteger(x);
+        }
+        doNotOptimize(a);
+    });
+
+    report("a * b, one limb", n, [&]() {
+        for (size_t i = 0; i + 1 < n; i++) {
+            BigInteger c = BigInteger(small[i]) * BigInteger(small[i + 1]);
+            doNotOptimize(c);
+        }
+    });
+
+    report("divmod, two by one limb", n, [&]() {
+        for (size_t i = 0; i + 1 < n; i++) {
+            BigInteger a = BigInteger(small[i]) * BigInteger(small[i]);
+            doNotOptimize(divmod(a, BigInteger(small[i + 1] | 1)));
+        }
+    });
+
+    std::vector<BigInteger> wide(1000);
+    for (BigInteger &x : wide) {
+        x = BigInteger(small[rnd() % n]);
+        for (int i = 0; i < 15; i++) {
+            x = x * BigInteger(small[rnd() % n]) + BigInteger(small[rnd() % n]);
+        }
+    }
+
+    report("a = a + b, 16 limbs", wide.size(), [&]() {
+        BigInteger a(0);
+        for (const BigInteger &x : wide) {
+            a = a + x;
+        }
+        doNotOptimize(a);
+    });
+
+    report("a += b, 16 limbs", wide.size(), [&]() {
+        BigInteger a(0);
+        for (const BigInteger &x : wide) {
+            a += x;
+        }
+        doNotOptimize(a);
+    });
+
+    report("a = a + b * c, 16 limbs", wide.size(), [&]() {
+        BigInteger a(0);
+        for (size_t i = 0; i + 1 < wide.size(); i++) {
+            a = a + wide[i] * wide[i + 1];
+        }
+        doNotOptimize(a);
+    });
+
+    report("addmul(a, b, c), 16 limbs", wide.size(), [&]() {
+        BigInteger a(0);
+        for (size_t i = 0; i + 1 < wide.size(); i++) {
+            addmul(a, wide[i], wide[i + 1]);
+        }
+        doNotOptimize(a);
+    });
+
+    report("Rational a + b, small", n / 10, [&]() {
+        for (size_t i = 0; i + 3 < n / 10; i++) {
+            Rational a(BigInteger(small[i] % 1000), BigInteger(1 + std::abs(small[i + 1] % 1000)));
+            Rational b(BigInteger(small[i + 2] % 1000), BigInteger(1 + std::abs(small[i + 3] % 1000)));
+            doNotOptimize(a + b);
+        }
+    });
+
+    return 0;
+}
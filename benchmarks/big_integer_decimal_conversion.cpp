@@ -0,0 +1,48 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-08.
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "../include/BigInteger.h"
+#include "benchmark_utils.h"
+
+// Compares the quadratic chunk-by-chunk conversion with the divide and conquer one
+int main() {
+    std::mt19937 rnd;
+    size_t defaultThreshold = BigInteger::decimalSplitThreshold;
+
+    printf("decimalSplitThreshold = %zu\n\n", defaultThreshold);
+    printf("%9s %16s %16s %16s %16s\n", "digits", "parse basic,us", "parse d&c,us", "print basic,us", "print d&c,us");
+
+    for (size_t digits = 1000; digits <= 1'000'000; digits *= 4) {
+        std::string s(digits, '0');
+        for (char &c : s) {
+            c = char('0' + rnd() % 10);
+        }
+        s[0] = '7';
+        BigInteger a(s);
+
+        double minMilliseconds = 50;
+        BigInteger::decimalSplitThreshold = SIZE_MAX;
+        double parseBasic = digits <= 300'000 ? measureMicroseconds([&]() {
+            doNotOptimize(BigInteger(s));
+        }, minMilliseconds) : -1;
+        double printBasic = digits <= 300'000 ? measureMicroseconds([&]() {
+            doNotOptimize(a.toString());
+        }, minMilliseconds) : -1;
+
+        BigInteger::decimalSplitThreshold = defaultThreshold;
+        double parseSplit = measureMicroseconds([&]() {
+            doNotOptimize(BigInteger(s));
+        }, minMilliseconds);
+        double printSplit = measureMicroseconds([&]() {
+            doNotOptimize(a.toString());
+        }, minMilliseconds);
+
+        printf("%9zu %16.1f %16.1f %16.1f %16.1f\n", digits, parseBasic, parseSplit, printBasic, printSplit);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-14.
+//
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include "../include/Rational.h"
+#include "benchmark_utils.h"
+
+// The loop Rational::reduce used before: one full division per Euclidean step
+BigInteger euclid(BigInteger a, BigInteger b) {
+    a = abs(a);
+    b = abs(b);
+    while (b > 0) {
+        a %= b;
+        std::swap(a, b);
+    }
+    return a;
+}
+
+BigInteger randomBigInteger(std::mt19937 &rnd, size_t decimalDigits) {
+    std::string s(decimalDigits, '0');
+    for (char &c : s) {
+        c = char('0' + rnd() % 10);
+    }
+    s[0] = char('1' + rnd() % 9);
+    return BigInteger(s);
+}
+
+// Compares the Euclidean loop with gcd() on random operands sharing a factor of half their length
+int main() {
+    std::mt19937 rnd;
+
+    printf("%9s %14s %14s %9s\n", "digits", "euclid,us", "gcd,us", "speedup");
+    for (size_t digits = 10; digits <= 100'000; digits *= 4) {
+        BigInteger common = randomBigInteger(rnd, digits / 2 + 1);
+        BigInteger a = randomBigInteger(rnd, digits / 2) * common;
+        BigInteger b = randomBigInteger(rnd, digits / 2) * common;
+
+        double minMilliseconds = 50;
+        double euclidTime = digits <= 30'000 ? measureMicroseconds([&]() {
+            doNotOptimize(euclid(a, b));
+        }, minMilliseconds) : -1;
+        double gcdTime = measureMicroseconds([&]() {
+            doNotOptimize(gcd(a, b));
+        }, minMilliseconds);
+
+        printf("%9zu %14.1f %14.1f %9.2f\n", digits, euclidTime, gcdTime, euclidTime > 0 ? euclidTime / gcdTime : 0);
+    }
+
+    // Every addition reduces the sum, the denominators grow to about n / ln(10) digits
+    printf("\n%9s %14s\n", "terms", "harmonic,us");
+    for (int n = 250; n <= 4000; n *= 2) {
+        double time = measureMicroseconds([&]() {
+            Rational sum;
+            for (int i = 1; i <= n; i++) {
+                sum += Rational(BigInteger(1), BigInteger(i));
+            }
+            doNotOptimize(sum);
+        }, 50);
+        printf("%9d %14.1f\n", n, time);
+    }
+    return 0;
+}
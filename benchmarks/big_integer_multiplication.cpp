@@ -0,0 +1,67 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-01.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/limb_arithmetic.h"
+#include "benchmark_utils.h"
+
+typedef LimbArithmetic::Limb Limb;
+typedef void (*MultiplicationKernel)(const Limb *, size_t, const Limb *, size_t, Limb *);
+
+// Measures one top-level step of the kernel, the recursive calls go through the regular dispatch,
+// so the crossover found here is exactly the threshold LimbArithmetic::multiply should use
+double measureKernel(MultiplicationKernel kernel, const std::vector<Limb> &a, const std::vector<Limb> &b) {
+    std::vector<Limb> r(a.size() + b.size());
+    return measureMicroseconds([&]() {
+        kernel(a.data(), a.size(), b.data(), b.size(), r.data());
+        doNotOptimize(r);
+    }, 100);
+}
+
+int main() {
+    std::mt19937 rnd;
+    auto randomLimbs = [&](size_t n) {
+        std::vector<Limb> res(n);
+        for (Limb &limb : res) {
+            limb = Limb(rnd());
+        }
+        return res;
+    };
+
+    printf("karatsubaThreshold = %zu, toom3Threshold = %zu, nttThreshold = %zu\n\n",
+           LimbArithmetic::karatsubaThreshold, LimbArithmetic::toom3Threshold, LimbArithmetic::nttThreshold);
+    printf("%8s %14s %14s %14s %14s\n", "limbs", "schoolbook,us", "karatsuba,us", "toom3,us", "ntt,us");
+
+    size_t karatsubaCrossover = 0;
+    size_t toom3Crossover = 0;
+    size_t nttCrossover = 0;
+    for (size_t n = 8; n <= 65536; n += n / 4) {
+        std::vector<Limb> a = randomLimbs(n);
+        std::vector<Limb> b = randomLimbs(n);
+
+        double schoolbook = n <= 2048 ? measureKernel(LimbArithmetic::multiplySchoolbook, a, b) : -1;
+        double karatsuba = n <= 8192 ? measureKernel(LimbArithmetic::multiplyKaratsuba, a, b) : -1;
+        double toom3 = n >= 16 ? measureKernel(LimbArithmetic::multiplyToom3, a, b) : -1;
+        double ntt = n >= 128 ? measureKernel(LimbArithmetic::multiplyNTT, a, b) : -1;
+
+        printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", n, schoolbook, karatsuba, toom3, ntt);
+
+        if (karatsubaCrossover == 0 && schoolbook > 0 && karatsuba < schoolbook) {
+            karatsubaCrossover = n;
+        }
+        if (toom3Crossover == 0 && toom3 > 0 && toom3 < karatsuba) {
+            toom3Crossover = n;
+        }
+        if (nttCrossover == 0 && ntt > 0 && ntt < toom3) {
+            nttCrossover = n;
+        }
+    }
+
+    printf("\nkaratsuba beats schoolbook from %zu limbs\n", karatsubaCrossover);
+    printf("toom3 beats karatsuba from %zu limbs\n", toom3Crossover);
+    printf("ntt beats toom3 from %zu limbs\n", nttCrossover);
+    return 0;
+}
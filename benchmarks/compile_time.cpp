@@ -0,0 +1,73 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-25.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Runs the compiler on the probe and returns false if it fails. Its peak memory comes from wait4
+bool compile(const std::vector<std::string> &flags, double &milliseconds, long &kilobytes) {
+    std::vector<std::string> arguments = {COMPILER, "-std=c++17", "-fsyntax-only", PROBE};
+    arguments.insert(arguments.end(), flags.begin(), flags.end());
+    std::vector<char *> argv;
+    for (std::string &argument : arguments) {
+        argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child == 0) {
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    rusage usage{};
+    if (child < 0 || wait4(child, &status, 0, &usage) != child) {
+        return false;
+    }
+    milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    kilobytes = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Compiler time and memory for the compile-time primality checks of compile_time_probe.cpp: trial division
+// by recursive templates, as IS_PRIME was implemented before, against the constexpr Miller-Rabin.
+// The recursion only reaches moduli below about 1.8 * 10^7 with -ftemplate-depth=12857
+int main() {
+    struct Configuration {
+        const char *name;
+        std::vector<std::string> flags;
+    };
+    std::vector<Configuration> configurations = {
+            {"no checks",                       {"-DNO_CHECKS"}},
+            {"template recursion",              {"-DTEMPLATE_RECURSION", "-ftemplate-depth=12857"}},
+            {"Miller-Rabin",                    {}},
+            {"Miller-Rabin, moduli up to 2^64", {"-DLARGE_MODULI"}},
+    };
+
+    printf("%-32s %10s %12s\n", "primality check", "time,ms", "memory,MiB");
+    for (const Configuration &configuration : configurations) {
+        // The fastest of a few runs, the first one also loads the compiler from disk
+        double best = 1e18;
+        long memory = 0;
+        for (int run = 0; run < 5; run++) {
+            double milliseconds = 0;
+            long kilobytes = 0;
+            if (!compile(configuration.flags, milliseconds, kilobytes)) {
+                printf("%-32s %10s\n", configuration.name, "failed");
+                return 1;
+            }
+            best = std::min(best, milliseconds);
+            memory = std::max(memory, kilobytes);
+        }
+        printf("%-32s %10.1f %12.1f\n", configuration.name, best, memory / 1024.0);
+    }
+    return 0;
+}
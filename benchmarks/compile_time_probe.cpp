@@ -0,0 +1,75 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-25.
+//
+
+// Translation unit compiled by compile_time_benchmark, it is not built on its own.
+// With TEMPLATE_RECURSION primality is checked by trial division through recursive templates, as IS_PRIME
+// did before, which needs -ftemplate-depth above 3 sqrt(N). LARGE_MODULI adds moduli that check cannot reach,
+// NO_CHECKS measures the rest of the translation unit
+
+#if defined(NO_CHECKS)
+
+#define IS_PRIME(N) true
+
+#elif defined(TEMPLATE_RECURSION)
+
+template<bool EXPR, typename T, typename F>
+struct TernaryOperator {
+    enum {
+        value = T::value
+    };
+};
+
+template<typename T, typename F>
+struct TernaryOperator<false, T, F> {
+    enum {
+        value = F::value
+    };
+};
+
+template<bool V>
+struct BooleanValue {
+    enum {
+        value = V
+    };
+};
+
+template<unsigned N, unsigned M>
+struct HasNonTrivialDivisors {
+    enum {
+        value = TernaryOperator<(N % M == 0), BooleanValue<false>,
+                TernaryOperator<(M * M <= N), HasNonTrivialDivisors<N, M + 1>, BooleanValue<true>>>::value
+    };
+};
+
+template<unsigned N>
+struct IsPrime {
+    enum {
+        value = TernaryOperator<(N < 2), BooleanValue<false>, HasNonTrivialDivisors<N, 2>>::value
+    };
+};
+
+#define IS_PRIME(N) IsPrime<N>::value
+
+#else
+
+#include "../src/num_theory_template_tricks.h"
+
+#endif
+
+static_assert(IS_PRIME(10159), "");
+static_assert(IS_PRIME(65537), "");
+static_assert(IS_PRIME(1000003), "");
+static_assert(IS_PRIME(16777259), "");
+
+#ifdef LARGE_MODULI
+static_assert(IS_PRIME(100000007), "");
+static_assert(IS_PRIME(1000000007), "");
+static_assert(IS_PRIME(2000000011), "");
+static_assert(IS_PRIME(4294967291u), "");
+static_assert(IS_PRIME(18446744073709551557ull), "");
+#endif
+
+int main() {
+    return 0;
+}
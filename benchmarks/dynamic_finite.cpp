@@ -0,0 +1,122 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-24.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+const unsigned smallModulus = 65537;
+const size_t n = 1 << 16;
+
+// Nanoseconds per product of a dependent chain and of independent products
+template<typename Multiply>
+void reportProducts(const char *name, const std::vector<uint32_t> &stored, Multiply multiply) {
+    double chain = measureMicroseconds([&]() {
+        uint32_t product = stored[0];
+        for (uint32_t x : stored) {
+            product = multiply(product, x);
+        }
+        doNotOptimize(product);
+    }) * 1000 / n;
+
+    std::vector<uint32_t> result(n);
+    double independent = measureMicroseconds([&]() {
+        for (size_t i = 0; i < n; i++) {
+            result[i] = multiply(stored[i], stored[n - 1 - i]);
+        }
+        doNotOptimize(result);
+    }) * 1000 / n;
+
+    printf("%-30s %14.2f %14.2f\n", name, chain, independent);
+}
+
+// Gaussian elimination of an N x N matrix, in microseconds
+template<unsigned N, typename Field>
+double measureElimination(std::mt19937 &rnd) {
+    SquareMatrix<N, Field> a;
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            a[i][j] = Field(rnd());
+        }
+    }
+    return measureMicroseconds([&]() {
+        doNotOptimize(a.det());
+    });
+}
+
+// Finite<M> with the modulus as a template argument against DynamicFinite with the same modulus in a context.
+// "64-bit % M" is the division by a modulus unknown at compile time the precomputed constants replace
+int main() {
+    std::mt19937 rnd;
+    std::vector<uint32_t> values(n);
+    for (uint32_t &x : values) {
+        x = rnd() % modulus;
+    }
+
+    RuntimeReduction odd(modulus), even(modulus + 1);
+    std::vector<uint32_t> montgomery(n), plain(n);
+    for (size_t i = 0; i < n; i++) {
+        montgomery[i] = MontgomeryReduction<modulus>::toStorage(values[i]);
+        plain[i] = even.toStorage(values[i]);
+    }
+
+    printf("M = %u\n\n%-30s %14s %14s\n", modulus, "product", "chain,ns", "independent,ns");
+    volatile unsigned runtimeModulus = modulus;
+    reportProducts("64-bit % M, M at run time", values, [m = unsigned(runtimeModulus)](uint32_t a, uint32_t b) {
+        return uint32_t((uint64_t) a * b % m);
+    });
+    reportProducts("Montgomery, M at compile time", montgomery, [](uint32_t a, uint32_t b) {
+        return MontgomeryReduction<modulus>::multiply(a, b);
+    });
+    reportProducts("Montgomery, M at run time", montgomery, [&](uint32_t a, uint32_t b) {
+        return odd.multiply(a, b);
+    });
+    reportProducts("Barrett, even M at run time", plain, [&](uint32_t a, uint32_t b) {
+        return even.multiply(a, b);
+    });
+
+    ModulusContext context(modulus);
+    ModulusContext::Scope scope(&context);
+    std::vector<Finite<modulus>> a, b;
+    std::vector<DynamicFinite> x, y;
+    for (size_t i = 0; i < 4096; i++) {
+        a.emplace_back(values[i]);
+        b.emplace_back(values[n - 1 - i]);
+        x.emplace_back(values[i]);
+        y.emplace_back(values[n - 1 - i]);
+    }
+    double finiteAxpy = measureMicroseconds([&]() {
+        FiniteKernels<modulus>::axpy(a.data(), b[0], b.data(), a.size());
+        doNotOptimize(a);
+    }) * 1000 / a.size();
+    double dynamicAxpy = measureMicroseconds([&]() {
+        DynamicFiniteKernels::axpy(x.data(), y[0], y.data(), x.size());
+        doNotOptimize(x);
+    }) * 1000 / x.size();
+    printf("\naxpy of 4096 elements, ns per element: Finite<M> %.3f, DynamicFinite %.3f\n", finiteAxpy, dynamicAxpy);
+
+    printf("\ndeterminant of 200 x 200 modulo %u, ms: Finite<M> %.2f", smallModulus,
+           measureElimination<200, Finite<smallModulus>>(rnd) / 1000);
+    ModulusContext smallContext(smallModulus);
+    {
+        ModulusContext::Scope smallScope(&smallContext);
+        printf(", DynamicFinite %.2f\n", measureElimination<200, DynamicFinite>(rnd) / 1000);
+    }
+    printf("determinant of 200 x 200 modulo %u, ms: DynamicFinite %.2f\n", modulus,
+           measureElimination<200, DynamicFinite>(rnd) / 1000);
+
+    SquareMatrix<80, BigInteger> integers;
+    for (size_t i = 0; i < 80; i++) {
+        for (size_t j = 0; j < 80; j++) {
+            integers[i][j] = BigInteger(int(rnd() % 2001) - 1000);
+        }
+    }
+    printf("multi-modular determinant of 80 x 80 integers, ms: %.2f\n", measureMicroseconds([&]() {
+        doNotOptimize(integers.det());
+    }) / 1000);
+    return 0;
+}
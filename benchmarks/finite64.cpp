@@ -0,0 +1,74 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-28.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Finite64.h"
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+// 31, 62 and 64 bits
+const unsigned prime31 = 2147483647;
+const uint64_t prime62 = 4611686018427387847ull;
+const uint64_t prime64 = 18446744073709551557ull;
+const size_t n = 1 << 16;
+
+// Nanoseconds per product of independent products, per product and per bit of the modulus
+template<typename Field>
+void reportProducts(const char *name, int bits, std::mt19937_64 &rnd) {
+    std::vector<Field> a, b;
+    for (size_t i = 0; i < n; i++) {
+        a.emplace_back(rnd());
+        b.emplace_back(rnd());
+    }
+    std::vector<Field> r = a;
+    double product = measureMicroseconds([&]() {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] * b[i];
+        }
+        doNotOptimize(r);
+    }) * 1000 / n;
+
+    // k * x + y, the inner loop of elimination
+    Field k(rnd());
+    double axpy = measureMicroseconds([&]() {
+        RowOperations<Field>::axpy(r.data(), k, a.data(), n);
+        doNotOptimize(r);
+    }) * 1000 / n;
+    printf("%-26s %6d %12.2f %12.3f %12.2f %12.3f\n", name, bits, product, product / bits, axpy, axpy / bits);
+}
+
+// Microseconds for the determinant of an N x N matrix, and per bit of the modulus
+template<unsigned N, typename Field>
+void reportDeterminant(const char *name, int bits, std::mt19937_64 &rnd) {
+    SquareMatrix<N, Field> a;
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = 0; j < N; j++) {
+            a[i][j] = Field(rnd());
+        }
+    }
+    double time = measureMicroseconds([&]() {
+        doNotOptimize(a.det());
+    });
+    printf("%-26s %6d %12.1f %12.2f\n", name, bits, time, time / bits);
+}
+
+// Finite64 with Montgomery multiplication by 128-bit products against Finite<M> with 32-bit words. Residues
+// modulo a 62-bit prime hold twice the bits of those modulo a 31-bit one, so a multi-modular computation
+// needs half as many primes and the 64-bit type pays off when a 64-bit operation is less than twice as slow
+int main() {
+    std::mt19937_64 rnd;
+    printf("%-26s %6s %12s %12s %12s %12s\n", "ns", "bits", "product", "per bit", "axpy", "per bit");
+    reportProducts<Finite<prime31>>("Finite<2^31 - 1>", 31, rnd);
+    reportProducts<Finite64<prime31>>("Finite64<2^31 - 1>", 31, rnd);
+    reportProducts<Finite64<prime62>>("Finite64<62-bit prime>", 62, rnd);
+    reportProducts<Finite64<prime64>>("Finite64<2^64 - 59>", 64, rnd);
+
+    printf("\n%-26s %6s %12s %12s\n", "determinant 200 x 200, us", "bits", "time", "per bit");
+    reportDeterminant<200, Finite<prime31>>("Finite<2^31 - 1>", 31, rnd);
+    reportDeterminant<200, Finite64<prime62>>("Finite64<62-bit prime>", 62, rnd);
+    reportDeterminant<200, Finite64<prime64>>("Finite64<2^64 - 59>", 64, rnd);
+    return 0;
+}
@@ -0,0 +1,119 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-28.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/DynamicFinite.h"
+#include "../include/Finite.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+const unsigned evenModulus = 1'000'000'008;
+const size_t n = 1 << 12;
+
+// The recursive square-and-multiply Finite::pow was before
+template<unsigned M>
+Finite<M> recursivePow(const Finite<M> &a, unsigned long long n) {
+    if (n == 0) {
+        return Finite<M>(1);
+    }
+    if (n % 2 == 0) {
+        Finite<M> res = recursivePow(a, n / 2);
+        return res * res;
+    }
+    return recursivePow(a, n - 1) * a;
+}
+
+// Nanoseconds per element of f over values
+template<typename T, typename F>
+double perElement(std::vector<T> &values, F f) {
+    return measureMicroseconds([&]() {
+        f();
+        doNotOptimize(values);
+    }) * 1000 / values.size();
+}
+
+// Nanoseconds per call of pow with exponents of 30 and 64 bits by the recursive and the sliding-window versions,
+// then per inverse of one inverse per element against Montgomery's batch inversion
+int main() {
+    std::mt19937_64 rnd;
+    std::vector<Finite<modulus>> values;
+    std::vector<unsigned long long> exponents30, exponents64;
+    for (size_t i = 0; i < n; i++) {
+        values.emplace_back(unsigned(rnd() % (modulus - 1) + 1));
+        exponents30.push_back(rnd() >> 34);
+        exponents64.push_back(rnd());
+    }
+
+    printf("%-28s %14s %14s\n", "pow, ns", "recursive", "windows");
+    for (const std::vector<unsigned long long> *exponents : {&exponents30, &exponents64}) {
+        std::vector<Finite<modulus>> res = values;
+        double recursive = perElement(res, [&]() {
+            for (size_t i = 0; i < n; i++) {
+                res[i] = recursivePow(values[i], (*exponents)[i]);
+            }
+        });
+        double windows = perElement(res, [&]() {
+            for (size_t i = 0; i < n; i++) {
+                res[i] = Finite<modulus>::pow(values[i], (*exponents)[i]);
+            }
+        });
+        printf("%-28s %14.1f %14.1f\n", exponents == &exponents30 ? "30-bit exponent" : "64-bit exponent",
+               recursive, windows);
+    }
+
+    std::vector<Finite<evenModulus>> units;
+    while (units.size() < n) {
+        // Odd and not divisible by 3, 7, 109 or 167, the odd factors of 10^9 + 8
+        unsigned x = unsigned(rnd() % evenModulus) | 1;
+        if (x % 3 != 0 && x % 7 != 0 && x % 109 != 0 && x % 167 != 0) {
+            units.emplace_back(x);
+        }
+    }
+    ModulusContext context(modulus);
+    ModulusContext::Scope scope(&context);
+    std::vector<DynamicFinite> dynamic;
+    for (const Finite<modulus> &x : values) {
+        dynamic.emplace_back(x.getValue());
+    }
+
+    printf("\n%-28s %14s %14s\n", "inverse, ns", "one by one", "batch");
+    std::vector<Finite<modulus>> res = values;
+    double single = perElement(res, [&]() {
+        for (size_t i = 0; i < n; i++) {
+            res[i] = values[i].getInverse();
+        }
+    });
+    double batch = perElement(res, [&]() {
+        res = values;
+        Finite<modulus>::invertAll(res.data(), n);
+    });
+    printf("%-28s %14.1f %14.1f\n", "Finite<10^9 + 7>, Fermat", single, batch);
+
+    std::vector<Finite<evenModulus>> evenRes = units;
+    single = perElement(evenRes, [&]() {
+        for (size_t i = 0; i < n; i++) {
+            evenRes[i] = units[i].getInverse();
+        }
+    });
+    batch = perElement(evenRes, [&]() {
+        evenRes = units;
+        Finite<evenModulus>::invertAll(evenRes.data(), n);
+    });
+    printf("%-28s %14.1f %14.1f\n", "Finite<10^9 + 8>, Euclid", single, batch);
+
+    std::vector<DynamicFinite> dynamicRes = dynamic;
+    single = perElement(dynamicRes, [&]() {
+        for (size_t i = 0; i < n; i++) {
+            dynamicRes[i] = dynamic[i].getInverse();
+        }
+    });
+    batch = perElement(dynamicRes, [&]() {
+        dynamicRes = dynamic;
+        DynamicFinite::invertAll(dynamicRes.data(), n);
+    });
+    printf("%-28s %14.1f %14.1f\n", "DynamicFinite, Euclid", single, batch);
+    return 0;
+}
@@ -0,0 +1,59 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-18.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/finite_kernels.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+typedef Finite<modulus> Field;
+typedef FiniteKernels<modulus> Kernels;
+
+// Nanoseconds per element of every kernel on every instruction set level the processor supports
+int main() {
+    std::mt19937 rnd;
+    const char *levelNames[] = {"scalar", "avx2", "avx512"};
+    SimdLevel supported = Kernels::level();
+
+    printf("M = %u\n", modulus);
+    for (size_t n : {size_t(4096), size_t(1) << 20}) {
+        std::vector<Field> a, b, r(n, Field(0));
+        for (size_t i = 0; i < n; i++) {
+            a.emplace_back(rnd());
+            b.emplace_back(rnd());
+        }
+        Field k(rnd());
+
+        printf("\nn = %zu\n%-8s %10s %10s %10s %10s %10s\n", n, "level", "add", "subtract", "multiply", "axpy", "dot");
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            if (level > supported) {
+                continue;
+            }
+            Kernels::levelLimit = level;
+            double add = measureMicroseconds([&]() {
+                Kernels::add(r.data(), a.data(), b.data(), n);
+                doNotOptimize(r);
+            }) * 1000 / n;
+            double subtract = measureMicroseconds([&]() {
+                Kernels::subtract(r.data(), a.data(), b.data(), n);
+                doNotOptimize(r);
+            }) * 1000 / n;
+            double multiply = measureMicroseconds([&]() {
+                Kernels::multiply(r.data(), a.data(), b.data(), n);
+                doNotOptimize(r);
+            }) * 1000 / n;
+            double axpy = measureMicroseconds([&]() {
+                Kernels::axpy(r.data(), k, a.data(), n);
+                doNotOptimize(r);
+            }) * 1000 / n;
+            double dot = measureMicroseconds([&]() {
+                doNotOptimize(Kernels::dot(a.data(), b.data(), n));
+            }) * 1000 / n;
+            printf("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f\n", levelNames[int(level)], add, subtract, multiply, axpy, dot);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-17.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Finite.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+const size_t n = 1 << 16;
+
+// x^e by squaring, as Finite<M>::pow does it
+template<typename Reduction>
+uint32_t power(uint32_t x, unsigned e) {
+    uint32_t result = Reduction::toStorage(1);
+    for (; e > 0; e >>= 1) {
+        if (e & 1) {
+            result = Reduction::multiply(result, x);
+        }
+        x = Reduction::multiply(x, x);
+    }
+    return result;
+}
+
+// One pass of radix-2 butterflies (u, v) -> (u + v * w, u - v * w) over the whole array, as in a transform
+template<typename Reduction>
+void butterflies(std::vector<uint32_t> &a, uint32_t w) {
+    size_t half = a.size() / 2;
+    for (size_t i = 0; i < half; i++) {
+        uint32_t u = a[i];
+        uint32_t v = Reduction::multiply(a[i + half], w);
+        a[i] = u + v >= modulus ? u + v - modulus : u + v;
+        a[i + half] = u >= v ? u - v : u - v + modulus;
+    }
+}
+
+// Time per multiplication for a dependent chain (latency), for independent products (throughput),
+// per butterfly and per modular inversion x^(M - 2)
+template<typename Reduction>
+void report(const char *name, const std::vector<uint32_t> &values) {
+    std::vector<uint32_t> stored(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        stored[i] = Reduction::toStorage(values[i]);
+    }
+
+    double chain = measureMicroseconds([&]() {
+        uint32_t product = stored[0];
+        for (uint32_t x : stored) {
+            product = Reduction::multiply(product, x);
+        }
+        doNotOptimize(product);
+    }) * 1000 / n;
+
+    std::vector<uint32_t> result(n);
+    double independent = measureMicroseconds([&]() {
+        for (size_t i = 0; i < n; i++) {
+            result[i] = Reduction::multiply(stored[i], stored[n - 1 - i]);
+        }
+        doNotOptimize(result);
+    }) * 1000 / n;
+
+    std::vector<uint32_t> transformed = stored;
+    double butterfly = measureMicroseconds([&]() {
+        butterflies<Reduction>(transformed, stored[1]);
+        doNotOptimize(transformed);
+    }) * 1000 / (n / 2);
+
+    double inversion = measureMicroseconds([&]() {
+        for (size_t i = 0; i < 1024; i++) {
+            doNotOptimize(power<Reduction>(stored[i], modulus - 2));
+        }
+    }) * 1000 / 1024;
+
+    printf("%-28s %14.2f %14.2f %14.2f %14.1f\n", name, chain, independent, butterfly, inversion);
+}
+
+int main() {
+    std::mt19937 rnd;
+    std::vector<uint32_t> values(n);
+    for (uint32_t &x : values) {
+        x = rnd() % modulus;
+    }
+
+    printf("M = %u\n\n", modulus);
+    printf("%-28s %14s %14s %14s %14s\n", "reduction", "chain,ns", "independent,ns", "butterfly,ns", "x^(M-2),ns");
+    report<PlainReduction<modulus>>("64-bit % M", values);
+    report<MontgomeryReduction<modulus>>("Montgomery", values);
+
+    return 0;
+}
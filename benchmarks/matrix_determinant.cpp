@@ -0,0 +1,102 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-22.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+// Microseconds of exact division against divmod for a quotient and a divisor of the given lengths
+void benchmarkDivision(std::mt19937 &rnd) {
+    printf("%8s %8s %12s %12s\n", "quotient", "divisor", "divmod", "exact");
+    for (size_t limbs : {2, 8, 32, 128, 512}) {
+        BigInteger q(1), b(1);
+        for (size_t i = 0; i < limbs; i++) {
+            q = (q << 32) + BigInteger(int(rnd() >> 1));
+            b = (b << 32) + BigInteger(int(rnd() >> 1));
+        }
+        BigInteger a = q * b;
+        double full = measureMicroseconds([&]() {
+            doNotOptimize(divmod(a, b));
+        });
+        double exact = measureMicroseconds([&]() {
+            doNotOptimize(divideExact(a, b));
+        });
+        printf("%8zu %8zu %12.3f %12.3f\n", limbs, limbs, full, exact);
+    }
+}
+
+// Milliseconds of the determinant of an n x n matrix of 32-bit integers by Gaussian elimination over
+// Rational, by Bareiss' algorithm over BigInteger and by the multi-modular method
+void benchmarkDeterminant(std::mt19937 &rnd) {
+    printf("\n%6s %12s %12s %12s\n", "n", "rational", "bareiss", "modular");
+    for (size_t n : {10, 20, 40, 80, 160}) {
+        std::vector<BigInteger> integers;
+        std::vector<Rational> rationals;
+        for (size_t i = 0; i < n * n; i++) {
+            integers.emplace_back(int(rnd()));
+            rationals.emplace_back(integers.back());
+        }
+
+        double minMilliseconds = n >= 40 ? 0 : 200;
+        double rational = n > 80 ? 0 : measureMicroseconds([&]() {
+            std::vector<Rational> a = rationals;
+            Rational det(1);
+            MatrixKernels<Rational>::eliminate(a.data(), n, n, n, false, &det);
+            doNotOptimize(det);
+        }, minMilliseconds) / 1000;
+        double bareiss = measureMicroseconds([&]() {
+            std::vector<BigInteger> a = integers;
+            BigInteger det(1);
+            MatrixKernels<BigInteger>::eliminateFractionFree(a.data(), n, n, n, &det);
+            doNotOptimize(det);
+        }, minMilliseconds) / 1000;
+        double modular = measureMicroseconds([&]() {
+            doNotOptimize(MultiModular::determinant(integers.data(), n, n));
+        }, minMilliseconds) / 1000;
+        printf("%6zu %12.2f %12.2f %12.2f\n", n, rational, bareiss, modular);
+        fflush(stdout);
+    }
+}
+
+// Milliseconds of solving an n x n system with 32-bit integer coefficients by Gauss-Jordan elimination over
+// Rational and by the multi-modular method
+void benchmarkSolve(std::mt19937 &rnd) {
+    printf("\n%6s %12s %12s\n", "n", "rational", "modular");
+    for (size_t n : {10, 20, 40, 80}) {
+        std::vector<BigInteger> integers, right;
+        std::vector<Rational> augmented;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                integers.emplace_back(int(rnd()));
+                augmented.emplace_back(integers.back());
+            }
+            right.emplace_back(int(rnd()));
+            augmented.emplace_back(right.back());
+        }
+        std::vector<Rational> x(n);
+
+        double minMilliseconds = n >= 40 ? 0 : 200;
+        double rational = measureMicroseconds([&]() {
+            std::vector<Rational> a = augmented;
+            MatrixKernels<Rational>::eliminate(a.data(), n + 1, n, n + 1, true);
+            doNotOptimize(a);
+        }, minMilliseconds) / 1000;
+        double modular = measureMicroseconds([&]() {
+            MultiModular::solve(integers.data(), n, n, right.data(), x.data());
+            doNotOptimize(x);
+        }, minMilliseconds) / 1000;
+        printf("%6zu %12.2f %12.2f\n", n, rational, modular);
+        fflush(stdout);
+    }
+}
+
+int main() {
+    std::mt19937 rnd;
+    benchmarkDivision(rnd);
+    benchmarkDeterminant(rnd);
+    benchmarkSolve(rnd);
+    return 0;
+}
@@ -0,0 +1,51 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-19.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+// Milliseconds of the textbook triple loop against the tiled kernel for n x n times n x n
+template<typename Field, typename Generator>
+void benchmark(const char *name, std::initializer_list<size_t> sizes, Generator generate) {
+    typedef MatrixKernels<Field> Kernels;
+
+    printf("\n%s\n%6s %12s %12s %8s\n", name, "n", "naive", "tiled", "speedup");
+    for (size_t n : sizes) {
+        std::vector<Field> a, b, c(n * n, Field(0));
+        for (size_t i = 0; i < n * n; i++) {
+            a.push_back(generate());
+            b.push_back(generate());
+        }
+        // Keep the slowest runs to a single repetition
+        double minMilliseconds = n >= 512 ? 0 : 200;
+
+        double naive = measureMicroseconds([&]() {
+            Kernels::multiplyNaive(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+            doNotOptimize(c);
+        }, minMilliseconds) / 1000;
+        double tiled = measureMicroseconds([&]() {
+            Kernels::multiply(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+            doNotOptimize(c);
+        }, minMilliseconds) / 1000;
+        printf("%6zu %12.3f %12.3f %8.2f\n", n, naive, tiled, naive / tiled);
+    }
+}
+
+int main() {
+    std::mt19937 rnd;
+
+    benchmark<Finite<1'000'000'007>>("Finite<1000000007>", {64, 128, 256, 512, 1024}, [&]() {
+        return Finite<1'000'000'007>(rnd());
+    });
+    benchmark<double>("double", {64, 128, 256, 512, 1024}, [&]() {
+        return double(rnd()) / rnd.max();
+    });
+    benchmark<Rational>("Rational", {16, 32, 64}, [&]() {
+        return Rational(BigInteger(int(rnd() % 2001) - 1000), BigInteger(int(rnd() % 1000) + 1));
+    });
+    return 0;
+}
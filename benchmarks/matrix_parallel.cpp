@@ -0,0 +1,78 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-21.
+//
+
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+typedef Finite<modulus> Field;
+typedef MatrixKernels<Field> Kernels;
+
+template<typename Field>
+std::vector<Field> randomElements(std::mt19937 &rnd, size_t n) {
+    std::vector<Field> res;
+    for (size_t i = 0; i < n; i++) {
+        res.emplace_back(rnd());
+    }
+    return res;
+}
+
+// Milliseconds of the parallel kernels over Finite<1000000007> from one thread up to the hardware threads,
+// with the speedup over one thread in parentheses
+int main() {
+    std::mt19937 rnd;
+    const size_t n = 1024;
+    std::vector<Field> a = randomElements<Field>(rnd, n * n);
+    std::vector<Field> b = randomElements<Field>(rnd, n * n);
+    std::vector<Field> c(n * n, Field(0));
+    std::vector<Field> e = randomElements<Field>(rnd, n * n);
+    std::vector<Field> echelon;
+
+    std::vector<size_t> threadCounts;
+    size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    printf("n = %zu\n%8s %18s %18s %18s %18s\n", n, "threads", "tiled product", "strassen", "elimination", "add");
+    std::vector<double> singleThreaded;
+    for (size_t threads : threadCounts) {
+        ThreadPool::instance().setThreadCount(threads);
+        std::vector<double> times = {
+                measureMicroseconds([&]() {
+                    Kernels::multiply(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+                    doNotOptimize(c);
+                }, 0),
+                measureMicroseconds([&]() {
+                    Kernels::multiplyStrassen(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+                    doNotOptimize(c);
+                }, 0),
+                measureMicroseconds([&]() {
+                    echelon = e;
+                    Kernels::eliminate(echelon.data(), n, n, n, false);
+                    doNotOptimize(echelon);
+                }, 0),
+                measureMicroseconds([&]() {
+                    Kernels::add(c.data(), n, a.data(), n, b.data(), n, n, n);
+                    doNotOptimize(c);
+                })
+        };
+        if (singleThreaded.empty()) {
+            singleThreaded = times;
+        }
+
+        printf("%8zu", threads);
+        for (size_t i = 0; i < times.size(); i++) {
+            printf(" %10.2f (%4.1fx)", times[i] / 1000, singleThreaded[i] / times[i]);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-20.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Matrix.h"
+#include "benchmark_utils.h"
+
+const unsigned modulus = 1'000'000'007;
+typedef Finite<modulus> Field;
+typedef MatrixKernels<Field> Kernels;
+
+// Milliseconds of the tiled classical product against Strassen-Winograd with several cutoffs, n x n times n x n.
+// Odd sizes show the cost of peeling
+int main() {
+    std::mt19937 rnd;
+    const size_t cutoffs[] = {64, 128, 256, 512};
+
+    printf("M = %u\n%6s %10s", modulus, "n", "tiled");
+    for (size_t cutoff : cutoffs) {
+        printf("   cut %4zu", cutoff);
+    }
+    printf("\n");
+
+    for (size_t n : {128, 256, 512, 1000, 1024, 1025, 2048}) {
+        std::vector<Field> a, b, c(n * n, Field(0));
+        for (size_t i = 0; i < n * n; i++) {
+            a.emplace_back(rnd());
+            b.emplace_back(rnd());
+        }
+        double minMilliseconds = n >= 512 ? 0 : 200;
+
+        printf("%6zu %10.2f", n, measureMicroseconds([&]() {
+            Kernels::multiply(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+            doNotOptimize(c);
+        }, minMilliseconds) / 1000);
+        for (size_t cutoff : cutoffs) {
+            Kernels::strassenCutoff = cutoff;
+            printf(" %10.2f", measureMicroseconds([&]() {
+                Kernels::multiplyStrassen(a.data(), n, b.data(), n, c.data(), n, n, n, n);
+                doNotOptimize(c);
+            }, minMilliseconds) / 1000);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
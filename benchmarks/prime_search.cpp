@@ -0,0 +1,76 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-26.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../src/math_utils.h"
+#include "benchmark_utils.h"
+
+// Trial division up to sqrt(n) on every integer, as findNextPrime searched before
+uint64_t trialDivisionNextPrime(uint64_t n) {
+    while (true) {
+        n++;
+        bool prime = n >= 2;
+        for (uint64_t i = 2; i * i <= n && prime; i++) {
+            prime = n % i != 0;
+        }
+        if (prime) {
+            return n;
+        }
+    }
+}
+
+// Milliseconds to find the 1000 primes following n: successive trial division, successive findNextPrime
+// and one findNextPrimes batch. Then nanoseconds per isPrime call on random odd numbers of 32 and 64 bits
+int main() {
+    const size_t count = 1000;
+    printf("%-22s %16s %16s %16s\n", "primes above", "trial division", "findNextPrime", "findNextPrimes");
+    for (uint64_t n : {uint64_t(1) << 30, uint64_t(1'000'000'007), uint64_t(1) << 40, uint64_t(1) << 62}) {
+        double trial = -1;
+        if (n < (uint64_t(1) << 40)) {
+            trial = measureMicroseconds([&]() {
+                uint64_t p = n;
+                for (size_t i = 0; i < count; i++) {
+                    p = trialDivisionNextPrime(p);
+                }
+                doNotOptimize(p);
+            }) / 1000;
+        }
+        double wheel = measureMicroseconds([&]() {
+            uint64_t p = n;
+            for (size_t i = 0; i < count; i++) {
+                p = findNextPrime(p);
+            }
+            doNotOptimize(p);
+        }) / 1000;
+        double batch = measureMicroseconds([&]() {
+            doNotOptimize(findNextPrimes(n, count));
+        }) / 1000;
+        if (trial < 0) {
+            printf("%-22llu %16s %16.3f %16.3f\n", (unsigned long long) n, "-", wheel, batch);
+        } else {
+            printf("%-22llu %16.3f %16.3f %16.3f\n", (unsigned long long) n, trial, wheel, batch);
+        }
+    }
+
+    std::mt19937_64 rnd;
+    std::vector<uint64_t> small(1 << 16), large(1 << 16);
+    for (size_t i = 0; i < small.size(); i++) {
+        small[i] = (rnd() >> 32) | 1;
+        large[i] = rnd() | 1;
+    }
+    for (const std::vector<uint64_t> *numbers : {&small, &large}) {
+        double perCall = measureMicroseconds([&]() {
+            size_t primes = 0;
+            for (uint64_t x : *numbers) {
+                primes += isPrime(x);
+            }
+            doNotOptimize(primes);
+        }) * 1000 / numbers->size();
+        printf("\nisPrime on random odd %d-bit numbers, ns: %.1f", numbers == &small ? 32 : 64, perCall);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-27.
+//
+
+#include <cstdio>
+#include <vector>
+#include "../src/prime_sieve.h"
+#include "benchmark_utils.h"
+
+// One byte per number over the whole range, as findPrimesOnSegment sieved before
+uint64_t countWholeRange(uint64_t n) {
+    std::vector<bool> prime(n + 1, true);
+    prime[0] = false;
+    prime[1] = false;
+    for (uint64_t i = 2; i * i <= n; i++) {
+        if (prime[i]) {
+            for (uint64_t j = i * i; j <= n; j += i) {
+                prime[j] = false;
+            }
+        }
+    }
+    uint64_t count = 0;
+    for (uint64_t i = 0; i <= n; i++) {
+        count += prime[i];
+    }
+    return count;
+}
+
+// Milliseconds to count the primes up to n by sieving the whole range at once and by the segmented sieve
+// sequentially and on every hardware thread, then to list the primes of windows far from zero
+int main() {
+    size_t hardwareThreads = ThreadPool::instance().threadCount();
+
+    printf("%-14s %14s %14s %14s %14s\n", "n", "primes", "whole range", "segmented", "threads");
+    for (uint64_t n = 1'000'000; n <= 10'000'000'000ull; n *= 10) {
+        uint64_t count = 0;
+        double whole = -1;
+        // The whole range takes n / 8 bytes
+        if (n <= 1'000'000'000) {
+            whole = measureMicroseconds([&]() {
+                doNotOptimize(countWholeRange(n));
+            }, 0) / 1000;
+        }
+        double segmented = measureMicroseconds([&]() {
+            count = countPrimesInRange(0, n);
+        }, 0) / 1000;
+        double parallel = measureMicroseconds([&]() {
+            doNotOptimize(countPrimesInRange(0, n, true));
+        }, 0) / 1000;
+        if (whole < 0) {
+            printf("%-14llu %14llu %14s %14.1f %14.1f\n", (unsigned long long) n, (unsigned long long) count, "-",
+                   segmented, parallel);
+        } else {
+            printf("%-14llu %14llu %14.1f %14.1f %14.1f\n", (unsigned long long) n, (unsigned long long) count,
+                   whole, segmented, parallel);
+        }
+    }
+    printf("(%zu threads)\n\n", hardwareThreads);
+
+    printf("%-22s %14s %14s\n", "primes in [lo, lo+10^7]", "primes", "time,ms");
+    for (uint64_t lo : {uint64_t(1'000'000'000'000ull), uint64_t(1'000'000'000'000'000ull), uint64_t(1) << 50}) {
+        std::vector<uint64_t> primes;
+        double time = measureMicroseconds([&]() {
+            primes = primesInRange(lo, lo + 10'000'000);
+        }, 0) / 1000;
+        printf("%-22llu %14zu %14.1f\n", (unsigned long long) lo, primes.size(), time);
+    }
+    return 0;
+}
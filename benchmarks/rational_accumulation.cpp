@@ -0,0 +1,58 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-15.
+//
+
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/RationalAccumulator.h"
+#include "benchmark_utils.h"
+
+std::vector<Rational> randomFractions(std::mt19937 &rnd, size_t n, int maxNumerator, int maxDenominator) {
+    std::vector<Rational> fractions;
+    fractions.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int numerator = int(rnd() % (2 * maxNumerator + 1)) - maxNumerator;
+        int denominator = 1 + int(rnd() % maxDenominator);
+        fractions.emplace_back(BigInteger(numerator), BigInteger(denominator));
+    }
+    return fractions;
+}
+
+// Sums 10^5 random fractions with Rational (reduced after every addition) and with RationalAccumulator
+int main() {
+    const size_t n = 100'000;
+    std::mt19937 rnd;
+
+    printf("normalizeThreshold = %zu\n\n", RationalAccumulator::normalizeThreshold);
+    printf("%16s %16s %14s %16s %9s\n", "max numerator", "max denominator", "eager,ms", "accumulator,ms", "speedup");
+
+    int maxDenominators[] = {1, 16, 100, 1000};
+    for (int maxDenominator : maxDenominators) {
+        std::vector<Rational> fractions = randomFractions(rnd, n, 1'000'000'000, maxDenominator);
+
+        Rational eagerSum;
+        double eager = measureMicroseconds([&]() {
+            eagerSum = Rational();
+            for (const Rational &q : fractions) {
+                eagerSum += q;
+            }
+        }, 0) / 1000;
+
+        Rational lazySum;
+        double lazy = measureMicroseconds([&]() {
+            RationalAccumulator sum;
+            for (const Rational &q : fractions) {
+                sum += q;
+            }
+            lazySum = sum.value();
+        }, 0) / 1000;
+
+        if (eagerSum != lazySum) {
+            printf("sums differ\n");
+            return 1;
+        }
+        printf("%16d %16d %14.1f %16.1f %9.2f\n", 1'000'000'000, maxDenominator, eager, lazy, eager / lazy);
+    }
+    return 0;
+}
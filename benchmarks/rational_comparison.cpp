@@ -0,0 +1,82 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-16.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/Rational.h"
+#include "benchmark_utils.h"
+
+BigInteger randomBigInteger(std::mt19937 &rnd, size_t decimalDigits, bool allowNegative) {
+    std::string s(decimalDigits, '0');
+    for (char &c : s) {
+        c = char('0' + rnd() % 10);
+    }
+    s[0] = char('1' + rnd() % 9);
+    if (allowNegative && rnd() % 2 == 0) {
+        s = "-" + s;
+    }
+    return BigInteger(s);
+}
+
+// The comparison Rational used before: two full products per call
+bool crossMultipliedLess(const Rational &a, const Rational &b) {
+    return a.getNumerator() * b.getDenominator() < a.getDenominator() * b.getNumerator();
+}
+
+// Sorts 10^5 random fractions with both comparisons
+void report(const char *name, const std::vector<Rational> &values) {
+    std::vector<Rational> sorted = values;
+    double crossMultiplied = measureMicroseconds([&]() {
+        sorted = values;
+        std::sort(sorted.begin(), sorted.end(), crossMultipliedLess);
+    }, 0) / 1000;
+    std::vector<Rational> expected = sorted;
+
+    double shortCircuited = measureMicroseconds([&]() {
+        sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+    }, 0) / 1000;
+
+    if (sorted != expected) {
+        printf("orders differ\n");
+        exit(1);
+    }
+    printf("%-40s %16.1f %16.1f %9.2f\n", name, crossMultiplied, shortCircuited, crossMultiplied / shortCircuited);
+}
+
+int main() {
+    const size_t n = 100'000;
+    std::mt19937 rnd;
+
+    printf("%-40s %16s %16s %9s\n", "values", "cross,ms", "short-circuit,ms", "speedup");
+
+    std::vector<Rational> values;
+    for (size_t i = 0; i < n; i++) {
+        values.emplace_back(randomBigInteger(rnd, 1 + rnd() % 9, true));
+    }
+    report("integers", values);
+
+    values.clear();
+    for (size_t i = 0; i < n; i++) {
+        values.emplace_back(randomBigInteger(rnd, 1 + rnd() % 30, true), randomBigInteger(rnd, 1 + rnd() % 30, false));
+    }
+    report("up to 30 / 30 digits", values);
+
+    values.clear();
+    for (size_t i = 0; i < n; i++) {
+        values.emplace_back(randomBigInteger(rnd, 200, true), randomBigInteger(rnd, 200, false));
+    }
+    report("200 / 200 digits", values);
+
+    values.clear();
+    BigInteger denominator = randomBigInteger(rnd, 100, false);
+    for (size_t i = 0; i < n; i++) {
+        values.emplace_back(randomBigInteger(rnd, 100, true), denominator + rnd() % 1000);
+    }
+    report("100 / 100 digits, close denominators", values);
+    return 0;
+}
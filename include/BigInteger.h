@@ -5,14 +5,26 @@
 #ifndef MATRIX_BIGINTEGER_H
 #define MATRIX_BIGINTEGER_H
 
+#include <charconv>
 #include <iostream>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include "../src/greatest_common_divisor.h"
+#include "../src/limb_arithmetic.h"
+#include "../src/limb_vector.h"
 
 
+// The magnitude is stored in base 2^32 limbs, least significant first, and the sign separately.
+// operator[] and length() expose these binary limbs, decimal digits only appear
+// in the string constructor, toString() and the stream operators.
+// Numbers of up to LimbVector::inlineCapacity limbs do not allocate memory.
 class BigInteger {
+public:
+    typedef LimbArithmetic::Limb Limb;
+
 private:
-    std::vector<int> digits;
+    LimbVector digits;
     int sign;
 
     int trim() {
@@ -29,77 +41,178 @@ private:
         return leadingZeros;
     }
 
-    void insertDigit(int i, int digit) {
-        digits.insert(digits.begin() + i, digit);
+    BigInteger(LimbVector &&digits, int sign) : digits(std::move(digits)), sign(sign) { trim(); }
+
+    // *this += productSign * |b| * |c|, the product goes to a buffer reused by the thread
+    void addProduct(const BigInteger &b, const BigInteger &c, int productSign) {
+        thread_local LimbVector product;
+        product.resize(b.length() + c.length());
+        LimbArithmetic::multiply(b.digits.data(), b.length(), c.digits.data(), c.length(), product.data());
+        addInPlace(product.data(), product.size(), productSign);
+    }
+
+    // *this += otherSign * |other|, where |other| = limbs[0..n)
+    BigInteger &addInPlace(const Limb *limbs, size_t n, int otherSign) {
+        while (n > 0 && limbs[n - 1] == 0) {
+            n--;
+        }
+        if (sign == otherSign) {
+            size_t size = std::max(length(), n);
+            digits.resize(size, 0);
+            Limb carry = LimbArithmetic::addTo(digits.data(), size, limbs, n);
+            if (carry) {
+                digits.push_back(carry);
+            }
+            trim();
+            return *this;
+        }
+
+        if (LimbArithmetic::compare(digits.data(), length(), limbs, n) >= 0) {
+            LimbArithmetic::subtractFrom(digits.data(), length(), limbs, std::min(n, length()));
+        } else {
+            digits.resize(n, 0);
+            LimbArithmetic::subtractReversed(digits.data(), limbs, n);
+            sign = otherSign;
+        }
+        trim();
+        return *this;
     }
 
 public:
-    static const long long base = 1'000'000'000;
-    static const int baseExponent = 9;
+    static constexpr long long base = LimbArithmetic::base;
+    static constexpr int limbBits = LimbArithmetic::limbBits;
 
-    explicit BigInteger(const std::string &s) : sign(1) {
-        for (int i = s.size(); i > 0; i -= baseExponent) {
+    // Amount of decimal digits converted at once by the string constructor and toString()
+    static const int decimalChunkExponent = 9;
+    static const Limb decimalChunk = 1'000'000'000;
 
-            int left = std::max(0, i - baseExponent);
-            int right = i;
-            int size = right - left;
+    // Numbers longer than this (in limbs) are converted to and from decimal by divide and conquer
+    static inline size_t decimalSplitThreshold = 96;
 
-            int currentDigit = atoi(s.substr(left, size).c_str());
-            digits.push_back(currentDigit);
-        }
-        if (digits.size() == 0) {
-            digits = {0};
-        } else {
-            if (s[0] == '-') {
-                digits.back() *= -1;
-                sign = -1;
-            }
+    // s is an optional sign followed by decimal digits
+    explicit BigInteger(const std::string &s) : sign(1) {
+        const char *begin = s.data();
+        const char *end = s.data() + s.size();
+        if (begin != end && (*begin == '-' || *begin == '+')) {
+            sign = *begin == '-' ? -1 : 1;
+            begin++;
         }
+
+        digits = std::move(fromDecimal(begin, end).digits);
         trim();
     }
 
-    explicit BigInteger(const std::vector<int> &digits, int sign = 1) : digits(digits), sign(sign) { trim(); }
+    explicit BigInteger(const std::vector<Limb> &digits, int sign = 1) :
+            digits(digits.data(), digits.data() + digits.size()), sign(sign) { trim(); }
 
-    BigInteger(int a) : BigInteger(std::to_string(a)) {}
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    BigInteger(T a) : sign(a < 0 ? -1 : 1) {
+        // The magnitude is computed in the unsigned type, so that the minimal value does not overflow
+        std::make_unsigned_t<T> magnitude = a < 0 ? -std::make_unsigned_t<T>(a) : std::make_unsigned_t<T>(a);
+        digits.push_back(Limb(magnitude));
+        if constexpr (sizeof(T) > sizeof(Limb)) {
+            for (magnitude >>= limbBits; magnitude != 0; magnitude >>= limbBits) {
+                digits.push_back(Limb(magnitude));
+            }
+        }
+    }
 
-    BigInteger(const BigInteger &a) : digits(a.digits), sign(a.sign) {}
+    BigInteger(const BigInteger &a) = default;
+
+    BigInteger(BigInteger &&a) noexcept = default;
 
     BigInteger() : sign(1) {}
 
     std::string toString() const {
-        std::string res = sign == -1 ? "-" : "";
-        for (int i = (int) digits.size() - 1; i >= 0; i--) {
-            std::string currentDigit = std::to_string(digits[i]);
-            if (i != (int) digits.size() - 1) {
-                int leadingZeros = baseExponent - (int) currentDigit.size();
-                currentDigit = std::string(leadingZeros, '0') + currentDigit;
+        BigInteger magnitude = abs(*this);
+
+        // The number is written as 9 * 2^level digits with leading zeros, where 10^(9 * 2^level) > |a|
+        size_t level = 0;
+        size_t width = decimalChunkExponent;
+        if (length() > decimalSplitThreshold) {
+            while (compareMagnitudes(decimalPower(level), magnitude) <= 0) {
+                level++;
+                width *= 2;
             }
-            res += currentDigit;
+        } else {
+            width = ((length() * 10 + decimalChunkExponent - 1) / decimalChunkExponent) * decimalChunkExponent;
         }
 
+        std::string res(width + 1, '0');
+        toDecimal(magnitude, level, &res[1], &res[0] + res.size());
+
+        size_t firstDigit = res.find_first_not_of('0', 1);
+        if (firstDigit == std::string::npos) {
+            return "0";
+        }
+        if (sign == -1) {
+            res[--firstDigit] = '-';
+        }
+        res.erase(0, firstDigit);
         return res;
     }
 
+    size_t bitLength() const {
+        size_t n = length();
+        while (n > 0 && digits[n - 1] == 0) {
+            n--;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        return n * limbBits - __builtin_clz(digits[n - 1]);
+    }
+
+    // Shifts the magnitude, the sign is kept
+    BigInteger &operator<<=(size_t bits) {
+        size_t limbShift = bits / limbBits;
+        LimbVector result(length() + limbShift + 1, 0);
+        result.back() = LimbArithmetic::shiftLeft(digits.data(), length(), int(bits % limbBits),
+                                                  result.data() + limbShift);
+        digits.swap(result);
+        trim();
+        return *this;
+    }
+
+    // Shifts the magnitude, the sign is kept, so negative numbers are rounded towards zero
+    BigInteger &operator>>=(size_t bits) {
+        size_t limbShift = bits / limbBits;
+        if (limbShift >= length()) {
+            digits = {0};
+            sign = 1;
+            return *this;
+        }
+        LimbVector result(length() - limbShift);
+        LimbArithmetic::shiftRight(digits.data() + limbShift, result.size(), int(bits % limbBits), result.data());
+        digits.swap(result);
+        trim();
+        return *this;
+    }
+
     int getSign() const {
         return sign;
     }
 
+    // Residue in [0, m), without forming a quotient
+    unsigned modulo(unsigned m) const {
+        Limb remainder = LimbArithmetic::remainderBySmall(digits.data(), length(), m);
+        return sign < 0 && remainder != 0 ? m - remainder : remainder;
+    }
+
     explicit operator bool() const {
         return digits.size() > 0 && digits.back() != 0;
     }
 
-    int operator[](size_t i) const {
+    Limb operator[](size_t i) const {
         return this->digits[i];
     }
 
     BigInteger &operator+=(const BigInteger &other) {
-        (*this) = (*this) + other;
-        return *this;
+        return addInPlace(other.digits.data(), other.length(), other.sign);
     }
 
     BigInteger &operator-=(const BigInteger &other) {
-        (*this) = (*this) - other;
-        return *this;
+        return addInPlace(other.digits.data(), other.length(), -other.sign);
     }
 
     BigInteger &operator*=(const BigInteger &other) {
@@ -108,12 +221,12 @@ public:
     }
 
     BigInteger &operator/=(const BigInteger &other) {
-        (*this) = (*this) / other;
+        (*this) = std::move(divmod(*this, other).first);
         return *this;
     }
 
     BigInteger &operator%=(const BigInteger &other) {
-        (*this) = (*this) % other;
+        (*this) = std::move(divmod(*this, other).second);
         return *this;
     }
 
@@ -143,8 +256,14 @@ public:
         return this->digits.size();
     }
 
+    friend int compareMagnitudes(const BigInteger &a, const BigInteger &b);
+
     friend BigInteger abs(const BigInteger &a);
 
+    friend BigInteger newtonReciprocal(const BigInteger &d);
+
+    friend BigInteger addSigned(const BigInteger &a, const BigInteger &b, int bSign);
+
     friend BigInteger operator+(const BigInteger &a, const BigInteger &b);
 
     friend BigInteger operator-(const BigInteger &a, const BigInteger &b);
@@ -157,28 +276,56 @@ public:
 
     friend BigInteger operator%(const BigInteger &a, const BigInteger &b);
 
-    BigInteger operator-() const {
+    friend BigInteger divideExact(const BigInteger &a, const BigInteger &b);
+
+    friend BigInteger gcd(const BigInteger &a, const BigInteger &b);
+
+    friend void addmul(BigInteger &a, const BigInteger &b, const BigInteger &c);
+
+    friend void submul(BigInteger &a, const BigInteger &b, const BigInteger &c);
+
+    BigInteger operator-() const & {
         BigInteger result(*this);
+        return -std::move(result);
+    }
 
-        if (result[result.length() - 1] == 0) {
-            result.sign = 1;
-        } else {
-            result.sign *= -1;
+    BigInteger operator-() && {
+        if (length() > 0 && digits.back() != 0) {
+            sign *= -1;
         }
-
-        return result;
+        return std::move(*this);
     }
 
     BigInteger &operator=(const BigInteger &other) = default;
 
+    BigInteger &operator=(BigInteger &&other) noexcept = default;
+
+    static BigInteger powerOfTen(size_t exponent);
+
+private:
+    static const BigInteger &decimalPower(size_t level);
+
+    static const BigInteger &decimalPowerReciprocal(size_t level);
+
+    static BigInteger fromDecimal(const char *begin, const char *end);
+
+    static void toDecimal(const BigInteger &a, size_t level, char *begin, char *end);
+
+public:
+
     BigInteger &operator=(int b) {
-        *this = BigInteger(std::to_string(b));
+        *this = BigInteger(b);
         return *this;
     }
 
 };
 
 
+// Compares |a| and |b|, returns -1, 0 or 1
+int compareMagnitudes(const BigInteger &a, const BigInteger &b) {
+    return LimbArithmetic::compare(a.digits.data(), a.length(), b.digits.data(), b.length());
+}
+
 bool operator==(const BigInteger &a, const BigInteger &b) {
     if (a.length() != b.length()) {
         return false;
@@ -200,22 +347,10 @@ bool operator!=(const BigInteger &a, const BigInteger &b) {
 }
 
 bool operator<(const BigInteger &a, const BigInteger &b) {
-    if (b.length() > a.length()) {
-        return (a.getSign() == -1 && b.getSign() == 1) ||
-               (a.getSign() == 1 && b.getSign() == 1);
-    } else if (a.length() > b.length()) {
-        return !(b < a);
-    }
-    for (int i = b.length() - 1; i >= 0; i--) {
-        int digitA = a[i] * a.getSign();
-        int digitB = b[i] * b.getSign();
-        if (digitA < digitB) {
-            return true;
-        } else if (digitA > digitB) {
-            return false;
-        }
+    if (a.getSign() != b.getSign()) {
+        return a.getSign() < b.getSign();
     }
-    return false;
+    return a.getSign() * compareMagnitudes(a, b) < 0;
 }
 
 
@@ -237,153 +372,301 @@ BigInteger abs(const BigInteger &a) {
     return res;
 }
 
-BigInteger operator+(const BigInteger &a, const BigInteger &b) {
-    std::vector<int> resultDigits;
-    if (a.sign != b.sign) {
-        BigInteger absA = abs(a);
-        BigInteger absB = abs(b);
-        BigInteger res = absA < absB ? absB - absA : absA - absB;
-        if ((a.sign == -1 && absA > absB) || (b.sign == -1 && absB > absA)) {
-            res.sign = -1;
-        }
-        return res;
-    }
+BigInteger abs(BigInteger &&a) {
+    return a.getSign() < 0 ? -std::move(a) : std::move(a);
+}
 
-    int digitOverflow = 0;
-    for (size_t i = 0; i < std::max(a.length(), b.length()) || digitOverflow; i++) {
-        if (i == resultDigits.size()) {
-            resultDigits.push_back(0);
-        }
+// Finds a + b if bSign is the sign of b and a - b if it is the opposite one
+BigInteger addSigned(const BigInteger &a, const BigInteger &b, int bSign) {
+    if (a.sign == bSign) {
+        const BigInteger &longer = a.length() >= b.length() ? a : b;
+        const BigInteger &shorter = a.length() >= b.length() ? b : a;
 
-        if (i < a.length()) {
-            resultDigits[i] += a[i];
-        }
-        if (i < b.length()) {
-            resultDigits[i] += b[i];
-        }
+        LimbVector resultDigits(longer.length() + 1);
+        std::copy(longer.digits.begin(), longer.digits.end(), resultDigits.begin());
+        resultDigits.back() = LimbArithmetic::addTo(resultDigits.data(), longer.length(),
+                                                    shorter.digits.data(), shorter.length());
+
+        return BigInteger(std::move(resultDigits), a.sign);
+    }
 
-        resultDigits[i] += (int) digitOverflow;
+    // Subtract the smaller magnitude from the larger one
+    bool swapped = compareMagnitudes(a, b) < 0;
+    const BigInteger &larger = swapped ? b : a;
+    const BigInteger &smaller = swapped ? a : b;
 
-        digitOverflow = resultDigits[i] >= BigInteger::base ? 1 : 0;
+    LimbVector resultDigits(larger.digits);
+    LimbArithmetic::subtractFrom(resultDigits.data(), resultDigits.size(), smaller.digits.data(), smaller.length());
 
-        if (digitOverflow) {
-            resultDigits[i] -= BigInteger::base;
-        }
-    }
-    BigInteger result(resultDigits);
-    result.sign = a.sign;
-    return result;
+    return BigInteger(std::move(resultDigits), swapped ? bSign : a.sign);
+}
+
+BigInteger operator+(const BigInteger &a, const BigInteger &b) {
+    return addSigned(a, b, b.sign);
 }
 
 
 BigInteger operator-(const BigInteger &a, const BigInteger &b) {
-    if (b.sign == -1) {
-        return a + abs(b);
-    }
-    if (a.sign == -1 && b.sign == 1) {
-        return -(abs(a) + abs(b));
-    }
+    return addSigned(a, b, -b.sign);
+}
 
-    if (abs(a) < abs(b)) {
-        return -(b - a);
-    }
+// The overloads for temporaries accumulate into the storage of one of the operands
 
-    std::vector<int> resultDigits(a.digits);
+BigInteger operator+(BigInteger &&a, const BigInteger &b) {
+    a += b;
+    return std::move(a);
+}
 
-    bool digitOverflow = false;
-    for (size_t i = 0; i < b.length() || digitOverflow; i++) {
-        long long digitA = a[i];
-        long long digitB = i < b.length() ? b[i] : 0;
-        resultDigits[i] = digitA - digitB;
+BigInteger operator+(const BigInteger &a, BigInteger &&b) {
+    b += a;
+    return std::move(b);
+}
 
-        if (digitOverflow) {
-            resultDigits[i]--;
-        }
-        digitOverflow = resultDigits[i] < 0;
+BigInteger operator+(BigInteger &&a, BigInteger &&b) {
+    a += b;
+    return std::move(a);
+}
 
-        if (digitOverflow) {
-            resultDigits[i] += BigInteger::base;
-        }
-    }
+BigInteger operator-(BigInteger &&a, const BigInteger &b) {
+    a -= b;
+    return std::move(a);
+}
 
-    return BigInteger(resultDigits);
+BigInteger operator-(const BigInteger &a, BigInteger &&b) {
+    b -= a;
+    return -std::move(b);
+}
+
+BigInteger operator-(BigInteger &&a, BigInteger &&b) {
+    a -= b;
+    return std::move(a);
 }
 
 
 BigInteger operator*(const BigInteger &a, const BigInteger &b) {
 
-    std::vector<int> resultDigits(a.length() + b.length());
+    LimbVector resultDigits(a.length() + b.length());
 
-    for (size_t i = 0; i < a.length(); i++) {
-        int carry = 0;
-        for (size_t j = 0; j < b.length() || carry; j++) {
-            long long digitA = a[i];
-            long long digitB = j < b.length() ? b[j] : 0;
+    LimbArithmetic::multiply(a.digits.data(), a.length(), b.digits.data(), b.length(), resultDigits.data());
 
-            long long cur = resultDigits[i + j] + digitA * digitB + carry;
+    return BigInteger(std::move(resultDigits), a.sign * b.sign);
+}
 
-            resultDigits[i + j] = cur % BigInteger::base;
-            carry = int(cur / BigInteger::base);
-        }
+
+// Non-negative greatest common divisor, gcd(0, 0) = 0
+BigInteger gcd(const BigInteger &a, const BigInteger &b) {
+    return BigInteger(GreatestCommonDivisor::compute(a.digits, b.digits), 1);
+}
+
+// Finds a += b * c without a temporary for the sum
+void addmul(BigInteger &a, const BigInteger &b, const BigInteger &c) {
+    const BigInteger &shorter = b.length() <= c.length() ? b : c;
+    const BigInteger &longer = b.length() <= c.length() ? c : b;
+
+    // The limbs of b and c must stay valid while a grows
+    if (shorter.length() == 1 && a.sign == b.sign * c.sign && &a != &b && &a != &c) {
+        size_t size = std::max(a.length(), longer.length()) + 1;
+        a.digits.resize(size, 0);
+        LimbArithmetic::addMultipleTo(a.digits.data(), size, longer.digits.data(), longer.length(), shorter[0]);
+        a.trim();
+        return;
     }
 
-    while (!resultDigits.empty() && resultDigits.back() == 0) {
-        resultDigits.pop_back();
+    a.addProduct(b, c, b.sign * c.sign);
+}
+
+// Finds a -= b * c without a temporary for the difference
+void submul(BigInteger &a, const BigInteger &b, const BigInteger &c) {
+    a.addProduct(b, c, -b.sign * c.sign);
+}
+
+// Quotient is rounded towards zero and the remainder has the sign of a, as for built-in integers
+std::pair<BigInteger, BigInteger> divmod(const BigInteger &a, const BigInteger &b) {
+
+    if (compareMagnitudes(a, b) < 0) {
+        return {BigInteger(0), a};
     }
 
-    if (a.sign * b.sign == -1) {
-        return -BigInteger(resultDigits);
+    LimbVector quotientDigits(a.length() - b.length() + 1);
+    LimbVector remainderDigits(b.length());
+
+    LimbArithmetic::divide(a.digits.data(), a.length(), b.digits.data(), b.length(),
+                           quotientDigits.data(), remainderDigits.data());
+
+    return {BigInteger(std::move(quotientDigits), a.sign * b.sign), BigInteger(std::move(remainderDigits), a.sign)};
+}
+
+BigInteger operator/(const BigInteger &a, const BigInteger &b) {
+    return divmod(a, b).first;
+}
+
+BigInteger operator%(const BigInteger &a, const BigInteger &b) {
+    return divmod(a, b).second;
+}
+
+// a / b when b is known to divide a, cheaper than divmod. The result is meaningless otherwise
+BigInteger divideExact(const BigInteger &a, const BigInteger &b) {
+    if (compareMagnitudes(a, b) < 0) {
+        return BigInteger(0);
     }
-    return BigInteger(resultDigits);
+
+    LimbVector quotientDigits(a.length() - b.length() + 1);
+    LimbArithmetic::divideExact(a.digits.data(), a.length(), b.digits.data(), b.length(), quotientDigits.data());
+
+    return BigInteger(std::move(quotientDigits), a.sign * b.sign);
 }
 
+BigInteger operator<<(const BigInteger &a, size_t bits) {
+    BigInteger res(a);
+    res <<= bits;
+    return res;
+}
 
-std::pair<BigInteger, BigInteger> divmod(const BigInteger &a, const BigInteger &b) {
+BigInteger operator>>(const BigInteger &a, size_t bits) {
+    BigInteger res(a);
+    res >>= bits;
+    return res;
+}
 
-    if (a.sign != b.sign) {
-        std::pair<BigInteger, BigInteger> d = divmod(abs(a), abs(b));
-        return {-d.first, -d.second};
+// Finds floor(2^(2L) / d) for d > 0 of L bits by Newton's iteration, the cost is a few multiplications
+BigInteger newtonReciprocal(const BigInteger &d) {
+    size_t bits = d.bitLength();
+    if (d.length() <= 2) {
+        return (BigInteger(1) << (2 * bits)) / d;
     }
 
-    BigInteger buffer;
-    BigInteger div;
+    // Reciprocal of the top half of d is correct to about L / 2 bits, one step doubles that
+    size_t shift = bits - (bits / 2 + 1);
+    BigInteger x = newtonReciprocal(d >> shift) << shift;
+    BigInteger x2 = x * x;
+    x = (x << 1) - ((d * x2) >> (2 * bits));
+
+    BigInteger remainder = (BigInteger(1) << (2 * bits)) - d * x;
+    while (remainder.getSign() < 0) {
+        x -= 1;
+        remainder += d;
+    }
+    while (remainder >= d) {
+        x += 1;
+        remainder -= d;
+    }
+    return x;
+}
 
-    int currentIdx = (int) a.length() - 1;
-    while (currentIdx >= 0) {
+// Divides 0 <= a < 2^(2L) by d > 0 of L bits, reciprocal must be newtonReciprocal(d)
+std::pair<BigInteger, BigInteger> divmodWithReciprocal(const BigInteger &a, const BigInteger &d,
+                                                       const BigInteger &reciprocal) {
+    // The estimate is at most two less than the quotient
+    BigInteger quotient = (a * reciprocal) >> (2 * d.bitLength());
+    BigInteger remainder = a - quotient * d;
+    while (remainder >= d) {
+        quotient += 1;
+        remainder -= d;
+    }
+    return {quotient, remainder};
+}
 
-        buffer.insertDigit(0, a[currentIdx--]);
+// Finds 10^(9 * 2^level), the powers are cached per thread
+const BigInteger &BigInteger::decimalPower(size_t level) {
+    static thread_local std::vector<BigInteger> powers;
+    while (powers.size() <= level) {
+        powers.push_back(powers.empty() ? BigInteger(decimalChunk) : powers.back() * powers.back());
+    }
+    return powers[level];
+}
 
-        while (currentIdx >= 0 && b > buffer) {
-            buffer.insertDigit(0, a[currentIdx--]);
-            div.insertDigit(0, 0);
+// Finds 10^exponent as a product of the cached powers 10^(9 * 2^level)
+BigInteger BigInteger::powerOfTen(size_t exponent) {
+    static const Limb smallPowers[decimalChunkExponent] = {1, 10, 100, 1'000, 10'000, 100'000, 1'000'000,
+                                                           10'000'000, 100'000'000};
+    BigInteger res(smallPowers[exponent % decimalChunkExponent]);
+    size_t chunks = exponent / decimalChunkExponent;
+    for (size_t level = 0; chunks > 0; level++, chunks >>= 1) {
+        if (chunks & 1) {
+            res *= decimalPower(level);
         }
+    }
+    return res;
+}
 
-        buffer.trim();
+const BigInteger &BigInteger::decimalPowerReciprocal(size_t level) {
+    static thread_local std::vector<BigInteger> reciprocals;
+    while (reciprocals.size() <= level) {
+        reciprocals.push_back(newtonReciprocal(decimalPower(reciprocals.size())));
+    }
+    return reciprocals[level];
+}
 
-        int l = 0, r = BigInteger::base;
-        while (r - l > 1) {
-            int mid = (r + l) / 2;
-            if (b * mid > buffer) {
-                r = mid;
-            } else {
-                l = mid;
+// Parses decimal digits [begin, end)
+BigInteger BigInteger::fromDecimal(const char *begin, const char *end) {
+    size_t size = end - begin;
+
+    if (size <= decimalSplitThreshold * decimalChunkExponent) {
+        // digits = digits * 10^9 + next chunk, from the most significant chunk
+        LimbVector limbs(size / decimalChunkExponent + 2, 0);
+        size_t length = 0;
+        size_t chunkSize = size % decimalChunkExponent == 0 ? decimalChunkExponent : size % decimalChunkExponent;
+        for (const char *chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize,
+                chunkSize = decimalChunkExponent) {
+            Limb chunk = 0;
+            std::from_chars(chunkBegin, chunkBegin + chunkSize, chunk);
+
+            Limb carry = LimbArithmetic::multiplyBySmall(limbs.data(), length, decimalChunk, limbs.data());
+            if (carry) {
+                limbs[length++] = carry;
+            }
+            limbs[length] = 0;
+            LimbArithmetic::addTo(limbs.data(), length + 1, &chunk, 1);
+            if (limbs[length]) {
+                length++;
             }
         }
+        limbs.resize(length);
+        return BigInteger(std::move(limbs), 1);
+    }
 
-        buffer -= b * l;
-
-        div.insertDigit(0, l);
+    // The lower part takes 9 * 2^level digits, at least half of the number
+    size_t level = 0;
+    while ((size_t(decimalChunkExponent) << (level + 1)) < size) {
+        level++;
     }
-    div.trim();
-    return {div, buffer};
-}
 
-BigInteger operator/(const BigInteger &a, const BigInteger &b) {
-    return divmod(a, b).first;
+    const char *middle = end - (size_t(decimalChunkExponent) << level);
+    return fromDecimal(begin, middle) * decimalPower(level) + fromDecimal(middle, end);
 }
 
-BigInteger operator%(const BigInteger &a, const BigInteger &b) {
-    return divmod(a, b).second;
+// Writes 0 <= a < 10^(9 * 2^level) as exactly end - begin digits with leading zeros
+void BigInteger::toDecimal(const BigInteger &a, size_t level, char *begin, char *end) {
+    if (level == 0 || a.length() <= decimalSplitThreshold) {
+        // Chunks of 9 digits from the least significant one, every segment width is a multiple of 9
+        LimbVector magnitude(a.digits);
+        size_t size = magnitude.size();
+        char *position = end;
+        while (size > 0 && magnitude[size - 1] == 0) {
+            size--;
+        }
+        while (size > 0) {
+            Limb chunk = LimbArithmetic::divideByConstant<decimalChunk>(magnitude.data(), size, magnitude.data());
+            while (size > 0 && magnitude[size - 1] == 0) {
+                size--;
+            }
+
+            char buffer[decimalChunkExponent];
+            char *chunkEnd = std::to_chars(buffer, buffer + decimalChunkExponent, chunk).ptr;
+            char *chunkBegin = position - decimalChunkExponent;
+            std::fill(chunkBegin, std::copy_backward(buffer, chunkEnd, position), '0');
+            position = chunkBegin;
+        }
+        std::fill(begin, position, '0');
+        return;
+    }
+
+    // a = q * 10^(9 * 2^(level - 1)) + r, both halves are written separately
+    char *middle = end - (size_t(decimalChunkExponent) << (level - 1));
+    std::pair<BigInteger, BigInteger> qr = divmodWithReciprocal(a, decimalPower(level - 1),
+                                                                decimalPowerReciprocal(level - 1));
+    toDecimal(qr.first, level - 1, begin, middle);
+    toDecimal(qr.second, level - 1, middle, end);
 }
 
 std::istream &operator>>(std::istream &in, BigInteger &a) {
@@ -0,0 +1,183 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-23.
+//
+
+#ifndef MATRIX_DYNAMIC_FINITE_H
+#define MATRIX_DYNAMIC_FINITE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../src/modular_reduction.h"
+#include "../src/num_theory_template_tricks.h"
+
+// Modulus of DynamicFinite chosen at run time, together with its reduction constants computed once.
+// Elements keep only their residue and take the modulus from the context installed on the current thread,
+// so that threads can work modulo different numbers while all of them share one instantiation of the code
+class ModulusContext {
+public:
+    explicit ModulusContext(unsigned modulus) : reduction(modulus) {}
+
+    ModulusContext(const ModulusContext &) = delete;
+
+    ModulusContext &operator=(const ModulusContext &) = delete;
+
+    unsigned getModulus() const {
+        return reduction.getModulus();
+    }
+
+    const RuntimeReduction &getReduction() const {
+        return reduction;
+    }
+
+    // The context of this thread, there must be one
+    static const ModulusContext &current() {
+        return *active;
+    }
+
+    static const ModulusContext *currentOrNull() {
+        return active;
+    }
+
+    // Installs a context on this thread until the end of the scope, scopes may nest
+    class Scope {
+    public:
+        explicit Scope(const ModulusContext *context) : previous(active) {
+            active = context;
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            active = previous;
+        }
+
+    private:
+        const ModulusContext *previous;
+    };
+
+private:
+    RuntimeReduction reduction;
+
+    static inline thread_local const ModulusContext *active = nullptr;
+};
+
+// Residue modulo the modulus of the current ModulusContext, the run-time counterpart of Finite<M> with the
+// same interface. Residues of odd moduli are kept in Montgomery form as in Finite<M>, so arrays of both
+// go through the same ResidueKernels. Mixing elements created under different contexts is not detected
+class DynamicFinite {
+public:
+    static DynamicFinite pow(const DynamicFinite &a, unsigned long long n) {
+        return slidingWindowPow(a, n, DynamicFinite(1));
+    }
+
+    // By the extended Euclidean algorithm, so the modulus does not have to be prime; the value must be
+    // coprime to it
+    DynamicFinite getInverse() const {
+        DynamicFinite res = *this;
+        res.value = reduction().invert(value);
+        return res;
+    }
+
+    DynamicFinite divideModulo(const DynamicFinite &other) const {
+        DynamicFinite res = *this;
+        res *= other.getInverse();
+        return res;
+    }
+
+    // Replaces every nonzero a[i] by its inverse with a single extended Euclidean algorithm, as Finite::invertAll
+    static void invertAll(DynamicFinite *a, size_t n) {
+        std::vector<DynamicFinite> prefix(n + 1, DynamicFinite(1));
+        for (size_t i = 0; i < n; i++) {
+            prefix[i + 1] = prefix[i];
+            if (a[i].value != 0) {
+                prefix[i + 1] *= a[i];
+            }
+        }
+        DynamicFinite inverse = prefix[n].getInverse();
+        for (size_t i = n; i-- > 0;) {
+            if (a[i].value != 0) {
+                DynamicFinite x = a[i];
+                a[i] = inverse;
+                a[i] *= prefix[i];
+                inverse *= x;
+            }
+        }
+    }
+
+    static unsigned getModulus() {
+        return reduction().getModulus();
+    }
+
+    DynamicFinite(const DynamicFinite &other) = default;
+
+    DynamicFinite &operator=(const DynamicFinite &other) = default;
+
+    explicit DynamicFinite(unsigned x) : value(reduction().toStorage(x)) {}
+
+    DynamicFinite &operator+=(const DynamicFinite &other) {
+        unsigned modulus = getModulus();
+        value = value >= modulus - other.value ? value - (modulus - other.value) : value + other.value;
+        return *this;
+    }
+
+    DynamicFinite &operator-=(const DynamicFinite &other) {
+        value = value >= other.value ? value - other.value : value - other.value + getModulus();
+        return *this;
+    }
+
+    DynamicFinite &operator*=(const DynamicFinite &other) {
+        value = reduction().multiply(value, other.value);
+        return *this;
+    }
+
+    DynamicFinite &operator/=(const DynamicFinite &other) {
+        return *this *= other.getInverse();
+    }
+
+    unsigned getValue() const {
+        return reduction().fromStorage(value);
+    }
+
+    friend bool operator==(const DynamicFinite &a, const DynamicFinite &b) {
+        return a.value == b.value;
+    }
+
+    friend bool operator!=(const DynamicFinite &a, const DynamicFinite &b) {
+        return a.value != b.value;
+    }
+
+private:
+    // In Montgomery form for odd moduli
+    unsigned value;
+
+    static const RuntimeReduction &reduction() {
+        return ModulusContext::current().getReduction();
+    }
+};
+
+DynamicFinite operator+(const DynamicFinite &a, const DynamicFinite &b) {
+    DynamicFinite result = a;
+    result += b;
+    return result;
+}
+
+DynamicFinite operator-(const DynamicFinite &a, const DynamicFinite &b) {
+    DynamicFinite result = a;
+    result -= b;
+    return result;
+}
+
+DynamicFinite operator*(const DynamicFinite &a, const DynamicFinite &b) {
+    DynamicFinite result = a;
+    result *= b;
+    return result;
+}
+
+DynamicFinite operator/(const DynamicFinite &a, const DynamicFinite &b) {
+    return a.divideModulo(b);
+}
+
+#endif //MATRIX_DYNAMIC_FINITE_H
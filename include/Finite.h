@@ -5,70 +5,106 @@
 #ifndef MATRIX_FINITE_H
 #define MATRIX_FINITE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 #include "../src/compile_time_assert.h"
+#include "../src/modular_reduction.h"
 #include "../src/num_theory_template_tricks.h"
 
+// Residue modulo M. Odd moduli keep the value in Montgomery form, which only shows up
+// in the constructor and getValue()
 template<unsigned M>
 class Finite {
 public:
-    static Finite pow(const Finite &a, unsigned n) {
-        if (n == 0) {
-            return Finite(1);
-        }
-
-        if (n % 2 == 0) {
-            Finite res = pow(a, n / 2);
-            return res * res;
-        }
+    typedef typename std::conditional<M % 2 == 1, MontgomeryReduction<M>, PlainReduction<M>>::type Reduction;
 
-        return pow(a, n - 1) * a;
+    static constexpr Finite pow(const Finite &a, unsigned long long n) {
+        return slidingWindowPow(a, n, Finite(1));
     }
 
-    Finite getInverse() {
-        COMPILE_ASSERT(IS_PRIME(M));
-        return pow(this, M - 2);
+    // Odd moduli must be prime and invert by Fermat's x^(M - 2), which stays in Montgomery form.
+    // Plain residues of even moduli are inverted by the extended Euclidean algorithm and only have
+    // to be coprime to M
+    constexpr Finite getInverse() const {
+        if constexpr (M % 2 == 1) {
+            COMPILE_ASSERT(IS_PRIME(M));
+            return pow(*this, M - 2);
+        } else {
+            Finite res = *this;
+            res.value = Reduction::invert(value);
+            return res;
+        }
     }
 
-    Finite divideModulo(Finite<M> &other) {
-        COMPILE_ASSERT(IS_PRIME(M));
-        return this * other.getInverse();
+    constexpr Finite divideModulo(const Finite<M> &other) const {
+        return *this * other.getInverse();
     };
 
-    Finite(const Finite<M> &other) {
-        this->value = other.value;
+    // Replaces every nonzero a[i] by its inverse by Montgomery's simultaneous inversion: one inverse of the
+    // product of all of them and three multiplications per element. Zeros are left as they are
+    static void invertAll(Finite *a, size_t n) {
+        // prefix[i] is the product of the nonzero a[0..i)
+        std::vector<Finite> prefix(n + 1, Finite(1));
+        for (size_t i = 0; i < n; i++) {
+            prefix[i + 1] = prefix[i];
+            if (a[i].value != 0) {
+                prefix[i + 1] *= a[i];
+            }
+        }
+        // The inverse of the product of the nonzero a[0..i]
+        Finite inverse = prefix[n].getInverse();
+        for (size_t i = n; i-- > 0;) {
+            if (a[i].value != 0) {
+                Finite x = a[i];
+                a[i] = inverse;
+                a[i] *= prefix[i];
+                inverse *= x;
+            }
+        }
     }
 
-    Finite &operator=(const Finite<M> &other) {
-        this->value = other.value;
-    }
+    Finite(const Finite<M> &other) = default;
 
-    explicit Finite(unsigned x) {
-        this->value = x % M;
-    }
+    Finite &operator=(const Finite<M> &other) = default;
+
+    constexpr explicit Finite(unsigned x) : value(Reduction::toStorage(x)) {}
 
-    Finite &operator+=(const Finite<M> &other) {
-        long long result = (long long) value + (long long) other.value;
+    constexpr Finite &operator+=(const Finite<M> &other) {
+        uint64_t result = (uint64_t) value + other.value;
         if (result >= M) {
             result -= M;
         }
-        value = result;
+        value = unsigned(result);
         return *this;
     }
 
-    Finite &operator*=(const Finite<M> &other) {
-        long long result = ((long long) value * (long long) other.value) % M;
-        value = result;
+    constexpr Finite &operator*=(const Finite<M> &other) {
+        value = Reduction::multiply(value, other.value);
         return *this;
     }
 
-    Finite &operator-=(const Finite<M> &other) {
-        long long result = (((long long) value - (long long) other.value) % M + M) % M;
-        value = result;
+    constexpr Finite &operator-=(const Finite<M> &other) {
+        // Wraps around modulo 2^32 when value < other.value, adding M brings it back
+        value = value >= other.value ? value - other.value : value - other.value + M;
         return *this;
     }
 
-    unsigned getValue() {
-        return value;
+    constexpr Finite &operator/=(const Finite<M> &other) {
+        return *this *= other.getInverse();
+    }
+
+    constexpr unsigned getValue() const {
+        return Reduction::fromStorage(value);
+    }
+
+    friend constexpr bool operator==(const Finite<M> &a, const Finite<M> &b) {
+        return a.value == b.value;
+    }
+
+    friend constexpr bool operator!=(const Finite<M> &a, const Finite<M> &b) {
+        return a.value != b.value;
     }
 
 private:
@@ -76,25 +112,29 @@ private:
 };
 
 template<unsigned M>
-Finite<M> operator+(const Finite<M> &a, const Finite<M> &b) {
+constexpr Finite<M> operator+(const Finite<M> &a, const Finite<M> &b) {
     Finite<M> result = a;
     result += b;
     return result;
 }
 
 template<unsigned M>
-Finite<M> operator-(const Finite<M> &a, const Finite<M> &b) {
+constexpr Finite<M> operator-(const Finite<M> &a, const Finite<M> &b) {
     Finite<M> result = a;
     result -= b;
     return result;
 }
 
 template<unsigned M>
-Finite<M> operator*(const Finite<M> &a, const Finite<M> &b) {
+constexpr Finite<M> operator*(const Finite<M> &a, const Finite<M> &b) {
     Finite<M> result = a;
     result *= b;
     return result;
 }
 
+template<unsigned M>
+constexpr Finite<M> operator/(const Finite<M> &a, const Finite<M> &b) {
+    return a.divideModulo(b);
+}
 
 #endif //MATRIX_FINITE_H
\ No newline at end of file
@@ -0,0 +1,126 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-28.
+//
+
+#ifndef MATRIX_FINITE64_H
+#define MATRIX_FINITE64_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../src/compile_time_assert.h"
+#include "../src/modular_reduction.h"
+#include "../src/num_theory_template_tricks.h"
+
+// Residue modulo an odd M < 2^64 in Montgomery form, Finite<M> for moduli of up to 64 bits.
+// One residue modulo a 62-bit prime carries as much as two modulo 31-bit primes
+template<uint64_t M>
+class Finite64 {
+public:
+    typedef MontgomeryReduction64<M> Reduction;
+
+    static constexpr Finite64 pow(const Finite64 &a, unsigned long long n) {
+        return slidingWindowPow(a, n, Finite64(1));
+    }
+
+    // By Fermat's x^(M - 2), M must be prime
+    constexpr Finite64 getInverse() const {
+        COMPILE_ASSERT(IS_PRIME(M));
+        return pow(*this, M - 2);
+    }
+
+    constexpr Finite64 divideModulo(const Finite64<M> &other) const {
+        return *this * other.getInverse();
+    };
+
+    // Replaces every nonzero a[i] by its inverse, as Finite::invertAll
+    static void invertAll(Finite64 *a, size_t n) {
+        std::vector<Finite64> prefix(n + 1, Finite64(1));
+        for (size_t i = 0; i < n; i++) {
+            prefix[i + 1] = prefix[i];
+            if (a[i].value != 0) {
+                prefix[i + 1] *= a[i];
+            }
+        }
+        Finite64 inverse = prefix[n].getInverse();
+        for (size_t i = n; i-- > 0;) {
+            if (a[i].value != 0) {
+                Finite64 x = a[i];
+                a[i] = inverse;
+                a[i] *= prefix[i];
+                inverse *= x;
+            }
+        }
+    }
+
+    Finite64(const Finite64<M> &other) = default;
+
+    Finite64 &operator=(const Finite64<M> &other) = default;
+
+    constexpr explicit Finite64(uint64_t x) : value(Reduction::toStorage(x)) {}
+
+    constexpr Finite64 &operator+=(const Finite64<M> &other) {
+        // value + other.value may not fit in 64 bits, so M - other.value is subtracted and M added back
+        // by a mask on underflow. A branch would mispredict on every other random residue
+        uint64_t complement = M - other.value;
+        value = value - complement + (M & (0 - uint64_t(value < complement)));
+        return *this;
+    }
+
+    constexpr Finite64 &operator*=(const Finite64<M> &other) {
+        value = Reduction::multiply(value, other.value);
+        return *this;
+    }
+
+    constexpr Finite64 &operator-=(const Finite64<M> &other) {
+        value = value - other.value + (M & (0 - uint64_t(value < other.value)));
+        return *this;
+    }
+
+    constexpr Finite64 &operator/=(const Finite64<M> &other) {
+        return *this *= other.getInverse();
+    }
+
+    constexpr uint64_t getValue() const {
+        return Reduction::fromStorage(value);
+    }
+
+    friend constexpr bool operator==(const Finite64<M> &a, const Finite64<M> &b) {
+        return a.value == b.value;
+    }
+
+    friend constexpr bool operator!=(const Finite64<M> &a, const Finite64<M> &b) {
+        return a.value != b.value;
+    }
+
+private:
+    uint64_t value;
+};
+
+template<uint64_t M>
+constexpr Finite64<M> operator+(const Finite64<M> &a, const Finite64<M> &b) {
+    Finite64<M> result = a;
+    result += b;
+    return result;
+}
+
+template<uint64_t M>
+constexpr Finite64<M> operator-(const Finite64<M> &a, const Finite64<M> &b) {
+    Finite64<M> result = a;
+    result -= b;
+    return result;
+}
+
+template<uint64_t M>
+constexpr Finite64<M> operator*(const Finite64<M> &a, const Finite64<M> &b) {
+    Finite64<M> result = a;
+    result *= b;
+    return result;
+}
+
+template<uint64_t M>
+constexpr Finite64<M> operator/(const Finite64<M> &a, const Finite64<M> &b) {
+    return a.divideModulo(b);
+}
+
+#endif //MATRIX_FINITE64_H
@@ -0,0 +1,273 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-19.
+//
+
+#ifndef MATRIX_MATRIX_H
+#define MATRIX_MATRIX_H
+
+#include <initializer_list>
+#include <vector>
+#include "../src/matrix_kernels.h"
+#include "../src/multi_modular.h"
+#include "DynamicFinite.h"
+#include "Finite.h"
+#include "Rational.h"
+
+// Dense Rows x Cols matrix over Field, stored row by row in one contiguous array.
+// Dimensions are template parameters, so products and sums of mismatching sizes do not compile
+template<unsigned Rows, unsigned Cols, typename Field = Rational>
+class Matrix {
+public:
+    typedef MatrixKernels<Field> Kernels;
+
+    // Zero matrix
+    Matrix() : elements(size_t(Rows) * Cols, Field(0)) {}
+
+    // Row by row, missing entries are zero
+    Matrix(std::initializer_list<std::initializer_list<Field>> rows) : Matrix() {
+        size_t i = 0;
+        for (const std::initializer_list<Field> &row : rows) {
+            std::copy(row.begin(), row.end(), (*this)[i++]);
+        }
+    }
+
+    static Matrix identity() {
+        static_assert(Rows == Cols, "only square matrices have an identity");
+        Matrix res;
+        for (size_t i = 0; i < Rows; i++) {
+            res[i][i] = Field(1);
+        }
+        return res;
+    }
+
+    static constexpr unsigned rows() {
+        return Rows;
+    }
+
+    static constexpr unsigned cols() {
+        return Cols;
+    }
+
+    // m[i][j] is the entry in row i and column j
+    Field *operator[](size_t i) {
+        return elements.data() + i * Cols;
+    }
+
+    const Field *operator[](size_t i) const {
+        return elements.data() + i * Cols;
+    }
+
+    Field *data() {
+        return elements.data();
+    }
+
+    const Field *data() const {
+        return elements.data();
+    }
+
+    std::vector<Field> getRow(size_t i) const {
+        return std::vector<Field>((*this)[i], (*this)[i] + Cols);
+    }
+
+    std::vector<Field> getColumn(size_t j) const {
+        std::vector<Field> res;
+        res.reserve(Rows);
+        for (size_t i = 0; i < Rows; i++) {
+            res.push_back((*this)[i][j]);
+        }
+        return res;
+    }
+
+    Matrix &operator+=(const Matrix &other) {
+        Kernels::add(data(), Cols, data(), Cols, other.data(), Cols, Rows, Cols);
+        return *this;
+    }
+
+    Matrix &operator-=(const Matrix &other) {
+        Kernels::subtract(data(), Cols, data(), Cols, other.data(), Cols, Rows, Cols);
+        return *this;
+    }
+
+    Matrix &operator*=(const Field &k) {
+        Kernels::scale(data(), Cols, k, Rows, Cols);
+        return *this;
+    }
+
+    // Only a square right operand keeps the dimensions
+    Matrix &operator*=(const Matrix<Cols, Cols, Field> &other) {
+        *this = *this * other;
+        return *this;
+    }
+
+    Matrix<Cols, Rows, Field> transposed() const {
+        Matrix<Cols, Rows, Field> res;
+        for (size_t i = 0; i < Rows; i++) {
+            for (size_t j = 0; j < Cols; j++) {
+                res[j][i] = (*this)[i][j];
+            }
+        }
+        return res;
+    }
+
+    size_t rank() const {
+        Matrix copy = *this;
+        return copy.eliminate();
+    }
+
+    // Integer and rational matrices from the multi-modular threshold on are reduced modulo many primes
+    Field det() const {
+        static_assert(Rows == Cols, "the determinant is defined for square matrices only");
+        if constexpr (std::is_same<Field, BigInteger>::value || std::is_same<Field, Rational>::value) {
+            if (Rows >= MultiModular::threshold) {
+                return MultiModular::determinant(data(), Cols, Rows);
+            }
+        }
+        Matrix copy = *this;
+        Field res(1);
+        copy.eliminate(&res);
+        return res;
+    }
+
+    // Row echelon form, fraction-free for integer matrices: there the entries are minors of this matrix
+    Matrix echelonForm() const {
+        Matrix res = *this;
+        res.eliminate();
+        return res;
+    }
+
+    Field trace() const {
+        static_assert(Rows == Cols, "the trace is defined for square matrices only");
+        Field res(0);
+        for (size_t i = 0; i < Rows; i++) {
+            res += (*this)[i][i];
+        }
+        return res;
+    }
+
+    // Gauss-Jordan elimination of [A | E], the matrix must be non-singular
+    Matrix inverted() const {
+        static_assert(Rows == Cols, "only square matrices can be inverted");
+        static_assert(!IsIntegerRing<Field>::value, "the inverse of an integer matrix is not an integer matrix");
+        std::vector<Field> augmented(2 * size_t(Rows) * Cols, Field(0));
+        for (size_t i = 0; i < Rows; i++) {
+            std::copy((*this)[i], (*this)[i] + Cols, augmented.begin() + i * 2 * Cols);
+            augmented[i * 2 * Cols + Cols + i] = Field(1);
+        }
+        Kernels::eliminate(augmented.data(), 2 * Cols, Rows, 2 * Cols, true);
+
+        Matrix res;
+        for (size_t i = 0; i < Rows; i++) {
+            std::copy(augmented.begin() + i * 2 * Cols + Cols, augmented.begin() + (i + 1) * 2 * Cols, res[i]);
+        }
+        return res;
+    }
+
+    void invert() {
+        *this = inverted();
+    }
+
+private:
+    std::vector<Field> elements;
+
+    // Integer matrices go through Bareiss' algorithm, there is no division to run Gauss' one
+    size_t eliminate(Field *determinant = nullptr) {
+        if constexpr (IsIntegerRing<Field>::value) {
+            return Kernels::eliminateFractionFree(data(), Cols, Rows, Cols, determinant);
+        } else {
+            return Kernels::eliminate(data(), Cols, Rows, Cols, false, determinant);
+        }
+    }
+};
+
+template<unsigned N, typename Field = Rational>
+using SquareMatrix = Matrix<N, N, Field>;
+
+// x with a * x = b by Gauss-Jordan elimination of [a | b], false if a is singular
+template<unsigned N, typename Field>
+bool solve(const SquareMatrix<N, Field> &a, const Matrix<N, 1, Field> &b, Matrix<N, 1, Field> &x) {
+    static_assert(!IsIntegerRing<Field>::value, "the solution of an integer system is rational");
+    Matrix<N, N + 1, Field> augmented;
+    for (size_t i = 0; i < N; i++) {
+        std::copy(a[i], a[i] + N, augmented[i]);
+        augmented[i][N] = b[i][0];
+    }
+    if (MatrixKernels<Field>::eliminate(augmented.data(), N + 1, N, N + 1, true) < N ||
+        augmented[N - 1][N - 1] == Field(0)) {
+        return false;
+    }
+    for (size_t i = 0; i < N; i++) {
+        x[i][0] = augmented[i][N];
+    }
+    return true;
+}
+
+// Large rational systems go through the multi-modular method
+template<unsigned N>
+bool solve(const SquareMatrix<N, Rational> &a, const Matrix<N, 1, Rational> &b, Matrix<N, 1, Rational> &x) {
+    if (N < MultiModular::threshold) {
+        return solve<N, Rational>(a, b, x);
+    }
+    return MultiModular::solve(a.data(), N, N, b.data(), x.data());
+}
+
+template<unsigned N>
+bool solve(const SquareMatrix<N, BigInteger> &a, const Matrix<N, 1, BigInteger> &b, Matrix<N, 1, Rational> &x) {
+    return MultiModular::solve(a.data(), N, N, b.data(), x.data());
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+bool operator==(const Matrix<Rows, Cols, Field> &a, const Matrix<Rows, Cols, Field> &b) {
+    for (size_t i = 0; i < Rows; i++) {
+        if (!std::equal(a[i], a[i] + Cols, b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+bool operator!=(const Matrix<Rows, Cols, Field> &a, const Matrix<Rows, Cols, Field> &b) {
+    return !(a == b);
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+Matrix<Rows, Cols, Field> operator+(const Matrix<Rows, Cols, Field> &a, const Matrix<Rows, Cols, Field> &b) {
+    Matrix<Rows, Cols, Field> res = a;
+    res += b;
+    return res;
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+Matrix<Rows, Cols, Field> operator-(const Matrix<Rows, Cols, Field> &a, const Matrix<Rows, Cols, Field> &b) {
+    Matrix<Rows, Cols, Field> res = a;
+    res -= b;
+    return res;
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+Matrix<Rows, Cols, Field> operator*(const Field &k, const Matrix<Rows, Cols, Field> &a) {
+    Matrix<Rows, Cols, Field> res = a;
+    res *= k;
+    return res;
+}
+
+template<unsigned Rows, unsigned Cols, typename Field>
+Matrix<Rows, Cols, Field> operator*(const Matrix<Rows, Cols, Field> &a, const Field &k) {
+    return k * a;
+}
+
+// The inner dimensions have to agree at compile time.
+// Exact fields go through Strassen-Winograd, which falls back to the tiled kernel for small sizes
+template<unsigned Rows, unsigned Inner, unsigned Cols, typename Field>
+Matrix<Rows, Cols, Field> operator*(const Matrix<Rows, Inner, Field> &a, const Matrix<Inner, Cols, Field> &b) {
+    typedef MatrixKernels<Field> Kernels;
+    Matrix<Rows, Cols, Field> res;
+    if constexpr (std::is_floating_point<Field>::value) {
+        Kernels::multiplyAdd(a.data(), Inner, b.data(), Cols, res.data(), Cols, Rows, Inner, Cols);
+    } else {
+        Kernels::multiplyStrassen(a.data(), Inner, b.data(), Cols, res.data(), Cols, Rows, Inner, Cols);
+    }
+    return res;
+}
+
+#endif //MATRIX_MATRIX_H
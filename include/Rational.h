@@ -6,26 +6,118 @@
 #define MATRIX_RATIONAL_H
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
 #include "BigInteger.h"
 
+// Numerator and denominator are always coprime and the denominator is positive
 class Rational {
 private:
     BigInteger numerator;
     BigInteger denominator;
 
     void reduce() {
-        BigInteger a = abs(numerator);
-        BigInteger b = abs(denominator);
-        while (b > 0) {
-            a %= b;
-            std::swap(a, b);
-        }
-        numerator /= a;
-        denominator /= a;
+        BigInteger divisor = gcd(numerator, denominator);
+        if (divisor != 1) {
+            numerator /= divisor;
+            denominator /= divisor;
+        }
         if (denominator < 0) {
-            numerator *= -1;
-            denominator *= -1;
+            numerator = -std::move(numerator);
+            denominator = -std::move(denominator);
+        }
+    }
+
+    // The 64 most significant bits of |a| as an integer with the top bit set, a has the given bit length > 0
+    static uint64_t leadingBits(const BigInteger &a, size_t bits) {
+        size_t limbs = std::min<size_t>(a.length(), 3);
+        unsigned __int128 window = 0;
+        for (size_t i = a.length(); i > a.length() - limbs; i--) {
+            window = (window << 32) | a[i - 1];
+        }
+        size_t windowBits = bits - 32 * (a.length() - limbs);
+        return uint64_t(windowBits >= 64 ? window >> (windowBits - 64) : window << (64 - windowBits));
+    }
+
+    static BigInteger divideOut(const BigInteger &a, const BigInteger &divisor) {
+        return divisor == 1 ? a : a / divisor;
+    }
+
+    // Henrici's addition of otherSign * other: only the common part of the denominators is
+    // multiplied out, so the numerator needs a gcd with d1 = gcd(b, d) instead of the full b * d.
+    // Every intermediate value is read before *this changes, so other may be *this
+    void add(const Rational &other, int otherSign) {
+        if (denominator == 1 && other.denominator == 1) {
+            if (otherSign > 0) {
+                numerator += other.numerator;
+            } else {
+                numerator -= other.numerator;
+            }
+            return;
+        }
+        if (other.denominator == 1) {
+            // a / b + c = (a + c * b) / b is reduced already
+            if (otherSign > 0) {
+                addmul(numerator, other.numerator, denominator);
+            } else {
+                submul(numerator, other.numerator, denominator);
+            }
+            return;
+        }
+        if (denominator == 1) {
+            numerator *= other.denominator;
+            if (otherSign > 0) {
+                numerator += other.numerator;
+            } else {
+                numerator -= other.numerator;
+            }
+            denominator = other.denominator;
+            return;
+        }
+
+        BigInteger d1 = gcd(denominator, other.denominator);
+        BigInteger ownScale = divideOut(denominator, d1);
+        BigInteger t = numerator * divideOut(other.denominator, d1);
+        if (otherSign > 0) {
+            addmul(t, other.numerator, ownScale);
+        } else {
+            submul(t, other.numerator, ownScale);
+        }
+        if (t == 0) {
+            numerator = 0;
+            denominator = 1;
+            return;
+        }
+
+        BigInteger d2 = d1 == 1 ? d1 : gcd(t, d1);
+        denominator = ownScale * divideOut(other.denominator, d2);
+        numerator = divideOut(t, d2);
+    }
+
+    // Multiplies by c / d, d != 0. The cross gcds cancel before multiplying, so the product is already reduced
+    void multiply(const BigInteger &c, const BigInteger &d) {
+        if (denominator == 1 && d == 1) {
+            numerator *= c;
+            return;
+        }
+        if (numerator == 0 || c == 0) {
+            numerator = 0;
+            denominator = 1;
+            return;
+        }
+
+        BigInteger g1 = gcd(numerator, d);
+        BigInteger g2 = gcd(denominator, c);
+        BigInteger newNumerator = divideOut(numerator, g1) * divideOut(c, g2);
+        BigInteger newDenominator = divideOut(denominator, g2) * divideOut(d, g1);
+        if (newDenominator < 0) {
+            newNumerator = -std::move(newNumerator);
+            newDenominator = -std::move(newDenominator);
         }
+        numerator = std::move(newNumerator);
+        denominator = std::move(newDenominator);
     }
 
 public:
@@ -39,6 +131,14 @@ public:
 
     Rational(const BigInteger &a, const BigInteger &b) : numerator(a), denominator(b) { reduce(); }
 
+    const BigInteger &getNumerator() const {
+        return numerator;
+    }
+
+    const BigInteger &getDenominator() const {
+        return denominator;
+    }
+
     std::string toString() const {
         if (abs(denominator) == 1) {
             return (numerator * denominator).toString();
@@ -52,34 +152,84 @@ public:
     Rational &operator=(const Rational &other) = default;
 
     explicit operator double() const {
-        return atof(asDecimal(100).c_str());
+        return toFloatingPoint<double>();
+    }
+
+    explicit operator long double() const {
+        return toFloatingPoint<long double>();
+    }
+
+    // Correctly rounded (to nearest, ties to even) value, including subnormals and infinities
+    template<typename Float>
+    Float toFloatingPoint() const {
+        typedef std::numeric_limits<Float> Limits;
+        static_assert(Limits::radix == 2 && Limits::digits <= 64, "the mantissa must fit in 64 bits");
+
+        if (!numerator) {
+            return 0;
+        }
+
+        // |numerator| / denominator lies in (2^(estimate - 1), 2^(estimate + 1))
+        long long estimate = (long long) numerator.bitLength() - (long long) denominator.bitLength();
+        if (estimate + 1 < Limits::min_exponent - Limits::digits - 1) {
+            // Below half of the smallest subnormal number
+            return numerator.getSign() * Float(0);
+        }
+        if (estimate - 1 > Limits::max_exponent) {
+            return numerator.getSign() * Limits::infinity();
+        }
+
+        // One division gives a quotient of digits + 1 or digits + 2 bits and a remainder for the sticky bit
+        long long shift = Limits::digits + 1 - estimate;
+        std::pair<BigInteger, BigInteger> qr = shift >= 0 ? divmod(abs(numerator) << size_t(shift), denominator)
+                                                          : divmod(abs(numerator), denominator << size_t(-shift));
+        unsigned __int128 quotient = 0;
+        for (size_t i = std::min<size_t>(qr.first.length(), 3); i > 0; i--) {
+            quotient = (quotient << 32) | qr.first[i - 1];
+        }
+
+        // The value is in [2^exponent, 2^(exponent + 1)), below the smallest normal number fewer mantissa bits remain
+        int quotientBits = int(qr.first.bitLength());
+        long long exponent = quotientBits - 1 - shift;
+        long long digits = std::min<long long>(Limits::digits, exponent - Limits::min_exponent + Limits::digits + 1);
+        if (digits < 0) {
+            return numerator.getSign() * Float(0);
+        }
+
+        int extra = quotientBits - int(digits);
+        unsigned __int128 mantissa = quotient >> extra;
+        bool roundBit = (quotient >> (extra - 1)) & 1;
+        bool sticky = (quotient & (((unsigned __int128) 1 << (extra - 1)) - 1)) != 0 || qr.second;
+        if (roundBit && (sticky || (mantissa & 1))) {
+            mantissa++;
+        }
+
+        // mantissa has at most 65 bits, 2^64 is the only value that needs halving
+        int scale = extra - int(shift);
+        if (mantissa >> 64) {
+            mantissa >>= 1;
+            scale++;
+        }
+        return numerator.getSign() * std::ldexp(Float(uint64_t(mantissa)), scale);
     }
 
     Rational &operator+=(const Rational &other) {
-        numerator = numerator * other.denominator + denominator * other.numerator;
-        denominator = denominator * other.denominator;
-        reduce();
+        add(other, 1);
         return *this;
     }
 
     Rational &operator-=(const Rational &other) {
-        numerator = numerator * other.denominator - denominator * other.numerator;
-        denominator = denominator * other.denominator;
-        reduce();
+        add(other, -1);
         return *this;
     }
 
     Rational &operator*=(const Rational &other) {
-        numerator *= other.numerator;
-        denominator *= other.denominator;
-        reduce();
+        multiply(other.numerator, other.denominator);
         return *this;
     }
 
     Rational &operator/=(const Rational &other) {
-        numerator *= other.denominator;
-        denominator *= other.numerator;
-        reduce();
+        multiply(other.denominator, other.numerator);
         return *this;
     }
 
@@ -89,52 +239,17 @@ public:
         return res;
     }
 
+    // The value truncated towards zero to precision digits after the point
     std::string asDecimal(size_t precision = 0) const {
-        BigInteger a = numerator;
-        BigInteger b = denominator;
-
-        int sign = a.getSign() * b.getSign();
-
-        a = abs(numerator);
-        b = abs(denominator);
-
-        int cnt = 0;
-
-        if (a != 0) {
-            while (a < b) {
-                a *= 10;
-                cnt++;
-            }
-            for (size_t i = 0; i < precision; i++) {
-                a *= 10;
-            }
-        }
-
-        a /= b;
-        std::string res = a.toString();
-
-        int point = res.size() - (cnt + precision);
-        int pointPosition;
-
-        if (point >= 0) {
-            res.insert(res.begin() + res.size() - (cnt + precision), '.');
-            pointPosition = res.size() - (cnt + precision);
-        } else {
-            res = "0." + std::string(abs(point), '0') + res;
-            pointPosition = 1;
+        BigInteger scaled = abs(numerator) * BigInteger::powerOfTen(precision) / denominator;
+        std::string digits = scaled.toString();
+        if (digits.size() <= precision) {
+            digits.insert(0, precision + 1 - digits.size(), '0');
         }
-
-        if (res[0] == '.') {
-            pointPosition = 1;
-            res = "0" + res;
+        if (precision > 0) {
+            digits.insert(digits.size() - precision, ".");
         }
-        res = res.substr(0, pointPosition + precision + 1);
-        if (res.back() == '.') {
-            res.pop_back();
-        }
-
-        res = (sign == -1 && a != 0 ? "-" : "") + res;
-        return res;
+        return (numerator.getSign() < 0 && scaled != 0 ? "-" : "") + digits;
     }
 
     friend Rational operator+(const Rational &a, const Rational &b);
@@ -145,6 +260,10 @@ public:
 
     friend Rational operator/(const Rational &a, const Rational &b);
 
+    friend int compare(const Rational &a, const Rational &b);
+
+    friend int compareMagnitudes(const Rational &a, const Rational &b);
+
     friend bool operator==(const Rational &a, const Rational &b);
 
     friend bool operator!=(const Rational &a, const Rational &b);
@@ -156,10 +275,67 @@ public:
     friend bool operator<=(const Rational &a, const Rational &b);
 
     friend bool operator>=(const Rational &a, const Rational &b);
+
+    friend class RationalAccumulator;
 };
 
+// Compares |a| and |b|. Cross products are only formed when the bit lengths and the leading 64 bits
+// of the numerators and the denominators cannot tell the values apart
+int compareMagnitudes(const Rational &a, const Rational &b) {
+    if (a.denominator == b.denominator) {
+        return compareMagnitudes(a.numerator, b.numerator);
+    }
+
+    // |a| lies in [2^(aScale - 1), 2^(aScale + 1))
+    size_t aNumeratorBits = a.numerator.bitLength();
+    size_t aDenominatorBits = a.denominator.bitLength();
+    size_t bNumeratorBits = b.numerator.bitLength();
+    size_t bDenominatorBits = b.denominator.bitLength();
+    long long scaleDifference = (long long) (aNumeratorBits + bDenominatorBits) - (long long) (bNumeratorBits + aDenominatorBits);
+    if (scaleDifference >= 2) {
+        return 1;
+    }
+    if (scaleDifference <= -2) {
+        return -1;
+    }
+
+    // The cross products of the leading bits are below the true ones scaled to 127 bits by less than 2^65
+    unsigned __int128 aCross = (unsigned __int128) Rational::leadingBits(a.numerator, aNumeratorBits) *
+                               Rational::leadingBits(b.denominator, bDenominatorBits) >> 2;
+    unsigned __int128 bCross = (unsigned __int128) Rational::leadingBits(b.numerator, bNumeratorBits) *
+                               Rational::leadingBits(a.denominator, aDenominatorBits) >> 2;
+    if (scaleDifference > 0) {
+        aCross <<= 1;
+    } else if (scaleDifference < 0) {
+        bCross <<= 1;
+    }
+    const unsigned __int128 tolerance = (unsigned __int128) 1 << 68;
+    if (aCross > bCross + tolerance) {
+        return 1;
+    }
+    if (bCross > aCross + tolerance) {
+        return -1;
+    }
+
+    return compareMagnitudes(a.numerator * b.denominator, b.numerator * a.denominator);
+}
+
+// Returns the sign of a - b
+int compare(const Rational &a, const Rational &b) {
+    int aSign = a.numerator ? a.numerator.getSign() : 0;
+    int bSign = b.numerator ? b.numerator.getSign() : 0;
+    if (aSign != bSign || aSign == 0) {
+        return aSign < bSign ? -1 : aSign > bSign;
+    }
+    if (a == b) {
+        return 0;
+    }
+    return aSign * compareMagnitudes(a, b);
+}
+
+// Both sides are in lowest terms with positive denominators, so equal values have equal limbs
 bool operator==(const Rational &a, const Rational &b) {
-    return a.numerator * b.denominator == a.denominator * b.numerator;
+    return a.numerator == b.numerator && a.denominator == b.denominator;
 }
 
 bool operator!=(const Rational &a, const Rational &b) {
@@ -167,12 +343,9 @@ bool operator!=(const Rational &a, const Rational &b) {
 }
 
 bool operator<(const Rational &a, const Rational &b) {
-    return a.numerator * b.denominator < a.denominator * b.numerator;
-    // -1 * -3 < 5 * 1, 3 < 5
+    return compare(a, b) < 0;
 }
 
-// a * d < b * c
-
 bool operator>(const Rational &a, const Rational &b) {
     return b < a;
 }
@@ -0,0 +1,127 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-15.
+//
+
+#ifndef MATRIX_RATIONAL_ACCUMULATOR_H
+#define MATRIX_RATIONAL_ACCUMULATOR_H
+
+#include <algorithm>
+#include <string>
+#include "BigInteger.h"
+#include "Rational.h"
+
+// Sum of Rationals with deferred normalization, for long sums such as dot products and row reductions.
+// Terms are brought to a common denominator without taking gcds. The fraction is reduced only by normalize(),
+// value(), toString() and when the denominator has grown past
+// max(normalizeThreshold, 2 * its length after the previous normalization) limbs
+class RationalAccumulator {
+public:
+    // Denominators of up to this many limbs are never reduced automatically
+    static inline size_t normalizeThreshold = 16;
+
+    RationalAccumulator() : numerator(0), denominator(1) {}
+
+    RationalAccumulator(const Rational &q) : numerator(q.numerator), denominator(q.denominator), reduced(true) {}
+
+    RationalAccumulator &operator+=(const Rational &q) {
+        addFraction(q.numerator, q.denominator, 1);
+        return *this;
+    }
+
+    RationalAccumulator &operator-=(const Rational &q) {
+        addFraction(q.numerator, q.denominator, -1);
+        return *this;
+    }
+
+    RationalAccumulator &operator+=(const RationalAccumulator &other) {
+        addFraction(other.numerator, other.denominator, 1);
+        return *this;
+    }
+
+    RationalAccumulator &operator-=(const RationalAccumulator &other) {
+        addFraction(other.numerator, other.denominator, -1);
+        return *this;
+    }
+
+    // Divides out the gcd of the numerator and the denominator. The represented value does not change,
+    // so this is const and the fields it touches are mutable
+    void normalize() const {
+        if (!reduced) {
+            BigInteger divisor = gcd(numerator, denominator);
+            if (divisor != 1) {
+                numerator /= divisor;
+                denominator /= divisor;
+            }
+            reduced = true;
+        }
+        normalizedLength = denominator.length();
+    }
+
+    Rational value() const {
+        normalize();
+        Rational res;
+        res.numerator = numerator;
+        res.denominator = denominator;
+        return res;
+    }
+
+    std::string toString() const {
+        return value().toString();
+    }
+
+    friend void addmul(RationalAccumulator &sum, const Rational &a, const Rational &b);
+
+    friend void submul(RationalAccumulator &sum, const Rational &a, const Rational &b);
+
+private:
+    mutable BigInteger numerator;
+    mutable BigInteger denominator;
+    mutable bool reduced = true;
+    mutable size_t normalizedLength = 1;
+
+    // Adds sign * c / d, d > 0. c and d may be the own numerator and denominator
+    void addFraction(const BigInteger &c, const BigInteger &d, int sign) {
+        if (&d == &denominator || d == denominator) {
+            if (sign > 0) {
+                numerator += c;
+            } else {
+                numerator -= c;
+            }
+        } else if (d == 1) {
+            if (sign > 0) {
+                addmul(numerator, c, denominator);
+            } else {
+                submul(numerator, c, denominator);
+            }
+        } else {
+            numerator *= d;
+            if (sign > 0) {
+                addmul(numerator, c, denominator);
+            } else {
+                submul(numerator, c, denominator);
+            }
+            denominator *= d;
+        }
+        reduced = false;
+
+        if (denominator.length() > std::max(normalizeThreshold, 2 * normalizedLength)) {
+            normalize();
+        }
+    }
+
+    void addProduct(const Rational &a, const Rational &b, int sign) {
+        addFraction(a.numerator * b.numerator, a.denominator * b.denominator, sign);
+    }
+};
+
+// Adds a * b without reducing the product
+void addmul(RationalAccumulator &sum, const Rational &a, const Rational &b) {
+    sum.addProduct(a, b, 1);
+}
+
+// Subtracts a * b without reducing the product
+void submul(RationalAccumulator &sum, const Rational &a, const Rational &b) {
+    sum.addProduct(a, b, -1);
+}
+
+#endif //MATRIX_RATIONAL_ACCUMULATOR_H
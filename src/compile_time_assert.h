@@ -14,7 +14,7 @@ struct compileTimeAssert {
 
 template<>
 struct compileTimeAssert<true> {
-    static void apply() {}
+    static constexpr void apply() {}
 };
 
 #define COMPILE_ASSERT(expr) compileTimeAssert<expr>::apply();
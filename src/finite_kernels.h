@@ -0,0 +1,516 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-18.
+//
+
+#ifndef MATRIX_FINITE_KERNELS_H
+#define MATRIX_FINITE_KERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "../include/DynamicFinite.h"
+#include "../include/Finite.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_FINITE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+enum class SimdLevel {
+    SCALAR, AVX2, AVX512
+};
+
+// Element-wise operations and dot products over arrays of stored residues, shared by all moduli:
+// the modulus and its Montgomery inverse are arguments, broadcast once per call, so Finite<M> and
+// DynamicFinite run the same single copy of the vectorized code. Products are Montgomery products and
+// need an odd modulus. Dot products add the high and the low halves of the 64-bit products separately,
+// the caller reduces the two sums once
+struct ResidueKernels {
+    static SimdLevel supportedLevel() {
+        static const SimdLevel supported = detectLevel();
+        return supported;
+    }
+
+    // r[i] = a[i] + b[i]
+    static void add(SimdLevel level, uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n,
+                    uint32_t modulus) {
+        size_t i = 0;
+#ifdef MATRIX_FINITE_KERNELS_X86
+        if (level == SimdLevel::AVX512) {
+            i = addAVX512(r, a, b, n, modulus);
+        } else if (level == SimdLevel::AVX2) {
+            i = addAVX2(r, a, b, n, modulus);
+        }
+#endif
+        for (; i < n; i++) {
+            r[i] = a[i] >= modulus - b[i] ? a[i] - (modulus - b[i]) : a[i] + b[i];
+        }
+    }
+
+    // r[i] = a[i] - b[i]
+    static void subtract(SimdLevel level, uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n,
+                         uint32_t modulus) {
+        size_t i = 0;
+#ifdef MATRIX_FINITE_KERNELS_X86
+        if (level == SimdLevel::AVX512) {
+            i = subtractAVX512(r, a, b, n, modulus);
+        } else if (level == SimdLevel::AVX2) {
+            i = subtractAVX2(r, a, b, n, modulus);
+        }
+#endif
+        for (; i < n; i++) {
+            r[i] = a[i] >= b[i] ? a[i] - b[i] : a[i] - b[i] + modulus;
+        }
+    }
+
+    // r[i] = a[i] * b[i] in Montgomery form
+    static void multiply(SimdLevel level, uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n,
+                         uint32_t modulus, uint32_t inverse) {
+        size_t i = 0;
+#ifdef MATRIX_FINITE_KERNELS_X86
+        if (level == SimdLevel::AVX512) {
+            i = multiplyAVX512(r, a, b, n, modulus, inverse);
+        } else if (level == SimdLevel::AVX2) {
+            i = multiplyAVX2(r, a, b, n, modulus, inverse);
+        }
+#endif
+        for (; i < n; i++) {
+            r[i] = montgomeryReduce((uint64_t) a[i] * b[i], modulus, inverse);
+        }
+    }
+
+    // y[i] += k * x[i] in Montgomery form
+    static void axpy(SimdLevel level, uint32_t *y, uint32_t k, const uint32_t *x, size_t n,
+                     uint32_t modulus, uint32_t inverse) {
+        size_t i = 0;
+#ifdef MATRIX_FINITE_KERNELS_X86
+        if (level == SimdLevel::AVX512) {
+            i = axpyAVX512(y, k, x, n, modulus, inverse);
+        } else if (level == SimdLevel::AVX2) {
+            i = axpyAVX2(y, k, x, n, modulus, inverse);
+        }
+#endif
+        for (; i < n; i++) {
+            uint32_t product = montgomeryReduce((uint64_t) k * x[i], modulus, inverse);
+            y[i] = y[i] >= modulus - product ? y[i] - (modulus - product) : y[i] + product;
+        }
+    }
+
+    // Adds the sum of a[i] * b[i] to high * 2^32 + low
+    static void dot(SimdLevel level, const uint32_t *a, const uint32_t *b, size_t n,
+                    uint64_t &high, uint64_t &low) {
+        size_t i = 0;
+#ifdef MATRIX_FINITE_KERNELS_X86
+        if (level == SimdLevel::AVX512) {
+            i = dotAVX512(a, b, n, high, low);
+        } else if (level == SimdLevel::AVX2) {
+            i = dotAVX2(a, b, n, high, low);
+        }
+#endif
+        for (; i < n; i++) {
+            uint64_t product = (uint64_t) a[i] * b[i];
+            high += product >> 32;
+            low += uint32_t(product);
+        }
+    }
+
+private:
+    static SimdLevel detectLevel() {
+#ifdef MATRIX_FINITE_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+#endif
+        return SimdLevel::SCALAR;
+    }
+
+#ifdef MATRIX_FINITE_KERNELS_X86
+
+    // a + b = a - (M - b), adding M back when a < M - b. Nothing exceeds 32 bits even for M close to 2^32
+    __attribute__((target("avx2")))
+    static __m256i addVector(__m256i a, __m256i b, __m256i modulus) {
+        __m256i complement = _mm256_sub_epi32(modulus, b);
+        __m256i difference = _mm256_sub_epi32(a, complement);
+        __m256i noBorrow = _mm256_cmpeq_epi32(_mm256_max_epu32(a, complement), a);
+        return _mm256_add_epi32(difference, _mm256_andnot_si256(noBorrow, modulus));
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i subtractVector(__m256i a, __m256i b, __m256i modulus) {
+        __m256i difference = _mm256_sub_epi32(a, b);
+        __m256i noBorrow = _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), a);
+        return _mm256_add_epi32(difference, _mm256_andnot_si256(noBorrow, modulus));
+    }
+
+    // Montgomery product of every lane, even and odd lanes are multiplied separately into 64 bits
+    __attribute__((target("avx2")))
+    static __m256i multiplyVector(__m256i a, __m256i b, __m256i modulus, __m256i inverse) {
+        __m256i evenProduct = _mm256_mul_epu32(a, b);
+        __m256i oddProduct = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        __m256i evenCorrection = _mm256_mul_epu32(_mm256_mul_epu32(evenProduct, inverse), modulus);
+        __m256i oddCorrection = _mm256_mul_epu32(_mm256_mul_epu32(oddProduct, inverse), modulus);
+
+        __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(evenProduct, 32), oddProduct, 0xAA);
+        __m256i correction = _mm256_blend_epi32(_mm256_srli_epi64(evenCorrection, 32), oddCorrection, 0xAA);
+        return subtractVector(high, correction, modulus);
+    }
+
+    __attribute__((target("avx2")))
+    static size_t addAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n, uint32_t m) {
+        const __m256i modulus = _mm256_set1_epi32(int(m));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+            _mm256_storeu_si256((__m256i *) (r + i), addVector(x, y, modulus));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t subtractAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n, uint32_t m) {
+        const __m256i modulus = _mm256_set1_epi32(int(m));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+            _mm256_storeu_si256((__m256i *) (r + i), subtractVector(x, y, modulus));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t multiplyAVX2(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n,
+                               uint32_t m, uint32_t mInverse) {
+        const __m256i modulus = _mm256_set1_epi32(int(m));
+        const __m256i inverse = _mm256_set1_epi32(int(mInverse));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+            _mm256_storeu_si256((__m256i *) (r + i), multiplyVector(x, y, modulus, inverse));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t axpyAVX2(uint32_t *y, uint32_t k, const uint32_t *x, size_t n, uint32_t m, uint32_t mInverse) {
+        const __m256i modulus = _mm256_set1_epi32(int(m));
+        const __m256i inverse = _mm256_set1_epi32(int(mInverse));
+        __m256i factor = _mm256_set1_epi32(int(k));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i product = multiplyVector(factor, _mm256_loadu_si256((const __m256i *) (x + i)), modulus, inverse);
+            __m256i sum = addVector(_mm256_loadu_si256((const __m256i *) (y + i)), product, modulus);
+            _mm256_storeu_si256((__m256i *) (y + i), sum);
+        }
+        return i;
+    }
+
+    // Each lane adds at most n / 4 halves below 2^32, so the 64-bit sums do not overflow
+    __attribute__((target("avx2")))
+    static size_t dotAVX2(const uint32_t *a, const uint32_t *b, size_t n, uint64_t &high, uint64_t &low) {
+        const __m256i lowMask = _mm256_set1_epi64x(0xFFFFFFFF);
+        __m256i highSum = _mm256_setzero_si256();
+        __m256i lowSum = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+            __m256i evenProduct = _mm256_mul_epu32(x, y);
+            __m256i oddProduct = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+            highSum = _mm256_add_epi64(highSum, _mm256_srli_epi64(evenProduct, 32));
+            highSum = _mm256_add_epi64(highSum, _mm256_srli_epi64(oddProduct, 32));
+            lowSum = _mm256_add_epi64(lowSum, _mm256_and_si256(evenProduct, lowMask));
+            lowSum = _mm256_add_epi64(lowSum, _mm256_and_si256(oddProduct, lowMask));
+        }
+
+        uint64_t lanes[4];
+        _mm256_storeu_si256((__m256i *) lanes, highSum);
+        high += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm256_storeu_si256((__m256i *) lanes, lowSum);
+        low += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i addVector(__m512i a, __m512i b, __m512i modulus) {
+        __m512i complement = _mm512_sub_epi32(modulus, b);
+        __m512i difference = _mm512_sub_epi32(a, complement);
+        return _mm512_mask_add_epi32(difference, _mm512_cmplt_epu32_mask(a, complement), difference, modulus);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i subtractVector(__m512i a, __m512i b, __m512i modulus) {
+        __m512i difference = _mm512_sub_epi32(a, b);
+        return _mm512_mask_add_epi32(difference, _mm512_cmplt_epu32_mask(a, b), difference, modulus);
+    }
+
+    __attribute__((target("avx512f")))
+    static __m512i multiplyVector(__m512i a, __m512i b, __m512i modulus, __m512i inverse) {
+        __m512i evenProduct = _mm512_mul_epu32(a, b);
+        __m512i oddProduct = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+        __m512i evenCorrection = _mm512_mul_epu32(_mm512_mul_epu32(evenProduct, inverse), modulus);
+        __m512i oddCorrection = _mm512_mul_epu32(_mm512_mul_epu32(oddProduct, inverse), modulus);
+
+        __m512i high = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(evenProduct, 32), oddProduct);
+        __m512i correction = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(evenCorrection, 32), oddCorrection);
+        return subtractVector(high, correction, modulus);
+    }
+
+    // The first count < 16 lanes. Short rows, as in the blocks of a matrix product, would otherwise spend
+    // a large part of their time in the scalar loop
+    static __mmask16 tailMask(size_t count) {
+        return __mmask16((1u << count) - 1);
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t addAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n, uint32_t m) {
+        const __m512i modulus = _mm512_set1_epi32(int(m));
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            _mm512_storeu_si512(r + i, addVector(x, y, modulus));
+        }
+        if (i < n) {
+            __mmask16 tail = tailMask(n - i);
+            __m512i x = _mm512_maskz_loadu_epi32(tail, a + i);
+            __m512i y = _mm512_maskz_loadu_epi32(tail, b + i);
+            _mm512_mask_storeu_epi32(r + i, tail, addVector(x, y, modulus));
+        }
+        return n;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t subtractAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n, uint32_t m) {
+        const __m512i modulus = _mm512_set1_epi32(int(m));
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            _mm512_storeu_si512(r + i, subtractVector(x, y, modulus));
+        }
+        if (i < n) {
+            __mmask16 tail = tailMask(n - i);
+            __m512i x = _mm512_maskz_loadu_epi32(tail, a + i);
+            __m512i y = _mm512_maskz_loadu_epi32(tail, b + i);
+            _mm512_mask_storeu_epi32(r + i, tail, subtractVector(x, y, modulus));
+        }
+        return n;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t multiplyAVX512(uint32_t *r, const uint32_t *a, const uint32_t *b, size_t n,
+                                 uint32_t m, uint32_t mInverse) {
+        const __m512i modulus = _mm512_set1_epi32(int(m));
+        const __m512i inverse = _mm512_set1_epi32(int(mInverse));
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            _mm512_storeu_si512(r + i, multiplyVector(x, y, modulus, inverse));
+        }
+        if (i < n) {
+            __mmask16 tail = tailMask(n - i);
+            __m512i x = _mm512_maskz_loadu_epi32(tail, a + i);
+            __m512i y = _mm512_maskz_loadu_epi32(tail, b + i);
+            _mm512_mask_storeu_epi32(r + i, tail, multiplyVector(x, y, modulus, inverse));
+        }
+        return n;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t axpyAVX512(uint32_t *y, uint32_t k, const uint32_t *x, size_t n, uint32_t m, uint32_t mInverse) {
+        const __m512i modulus = _mm512_set1_epi32(int(m));
+        const __m512i inverse = _mm512_set1_epi32(int(mInverse));
+        __m512i factor = _mm512_set1_epi32(int(k));
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i product = multiplyVector(factor, _mm512_loadu_si512(x + i), modulus, inverse);
+            _mm512_storeu_si512(y + i, addVector(_mm512_loadu_si512(y + i), product, modulus));
+        }
+        if (i < n) {
+            __mmask16 tail = tailMask(n - i);
+            __m512i product = multiplyVector(factor, _mm512_maskz_loadu_epi32(tail, x + i), modulus, inverse);
+            __m512i sum = addVector(_mm512_maskz_loadu_epi32(tail, y + i), product, modulus);
+            _mm512_mask_storeu_epi32(y + i, tail, sum);
+        }
+        return n;
+    }
+
+    __attribute__((target("avx512f")))
+    static size_t dotAVX512(const uint32_t *a, const uint32_t *b, size_t n, uint64_t &high, uint64_t &low) {
+        const __m512i lowMask = _mm512_set1_epi64(0xFFFFFFFF);
+        __m512i highSum = _mm512_setzero_si512();
+        __m512i lowSum = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            __m512i evenProduct = _mm512_mul_epu32(x, y);
+            __m512i oddProduct = _mm512_mul_epu32(_mm512_srli_epi64(x, 32), _mm512_srli_epi64(y, 32));
+            highSum = _mm512_add_epi64(highSum, _mm512_srli_epi64(evenProduct, 32));
+            highSum = _mm512_add_epi64(highSum, _mm512_srli_epi64(oddProduct, 32));
+            lowSum = _mm512_add_epi64(lowSum, _mm512_and_si512(evenProduct, lowMask));
+            lowSum = _mm512_add_epi64(lowSum, _mm512_and_si512(oddProduct, lowMask));
+        }
+        high += _mm512_reduce_add_epi64(highSum);
+        low += _mm512_reduce_add_epi64(lowSum);
+        return i;
+    }
+
+#endif
+};
+
+// ResidueKernels over contiguous arrays of Finite<M>. The widest instruction set supported by the processor
+// is picked at runtime. Products of even moduli are not in Montgomery form and multiply in the scalar code
+template<unsigned M>
+struct FiniteKernels {
+    typedef typename Finite<M>::Reduction Reduction;
+
+    static_assert(std::is_trivially_copyable<Finite<M>>::value && std::is_standard_layout<Finite<M>>::value &&
+                  sizeof(Finite<M>) == sizeof(uint32_t), "Finite<M> must be a plain 32-bit value");
+
+    // Kernels never use instructions above this level, lowering it lets the narrower paths be tested
+    static inline SimdLevel levelLimit = SimdLevel::AVX512;
+
+    static SimdLevel level() {
+        return std::min(ResidueKernels::supportedLevel(), levelLimit);
+    }
+
+    // r[i] = a[i] + b[i]
+    static void add(Finite<M> *r, const Finite<M> *a, const Finite<M> *b, size_t n) {
+        ResidueKernels::add(level(), raw(r), raw(a), raw(b), n, M);
+    }
+
+    // r[i] = a[i] - b[i]
+    static void subtract(Finite<M> *r, const Finite<M> *a, const Finite<M> *b, size_t n) {
+        ResidueKernels::subtract(level(), raw(r), raw(a), raw(b), n, M);
+    }
+
+    // r[i] = a[i] * b[i]
+    static void multiply(Finite<M> *r, const Finite<M> *a, const Finite<M> *b, size_t n) {
+        if constexpr (M % 2 == 1) {
+            ResidueKernels::multiply(level(), raw(r), raw(a), raw(b), n, M, Reduction::inverse);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                r[i] = a[i] * b[i];
+            }
+        }
+    }
+
+    // y[i] += k * x[i]
+    static void axpy(Finite<M> *y, const Finite<M> &k, const Finite<M> *x, size_t n) {
+        if constexpr (M % 2 == 1) {
+            ResidueKernels::axpy(level(), raw(y), raw(&k)[0], raw(x), n, M, Reduction::inverse);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                y[i] += k * x[i];
+            }
+        }
+    }
+
+    // Sum of a[i] * b[i]
+    static Finite<M> dot(const Finite<M> *a, const Finite<M> *b, size_t n) {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        ResidueKernels::dot(level(), raw(a), raw(b), n, high, low);
+        Finite<M> res(0);
+        raw(&res)[0] = Reduction::reduceSum(high, low);
+        return res;
+    }
+
+private:
+    // The stored residues, in Montgomery form for odd M
+    static uint32_t *raw(Finite<M> *a) {
+        return reinterpret_cast<uint32_t *>(a);
+    }
+
+    static const uint32_t *raw(const Finite<M> *a) {
+        return reinterpret_cast<const uint32_t *>(a);
+    }
+};
+
+// The same kernels over DynamicFinite. The constants are read from the context of the calling thread
+// once per call instead of once per element
+struct DynamicFiniteKernels {
+    static_assert(std::is_trivially_copyable<DynamicFinite>::value &&
+                  std::is_standard_layout<DynamicFinite>::value &&
+                  sizeof(DynamicFinite) == sizeof(uint32_t), "DynamicFinite must be a plain 32-bit value");
+
+    static inline SimdLevel levelLimit = SimdLevel::AVX512;
+
+    static SimdLevel level() {
+        return std::min(ResidueKernels::supportedLevel(), levelLimit);
+    }
+
+    static void add(DynamicFinite *r, const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        ResidueKernels::add(level(), raw(r), raw(a), raw(b), n, reduction().getModulus());
+    }
+
+    static void subtract(DynamicFinite *r, const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        ResidueKernels::subtract(level(), raw(r), raw(a), raw(b), n, reduction().getModulus());
+    }
+
+    static void multiply(DynamicFinite *r, const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        const RuntimeReduction &context = reduction();
+        if (context.isMontgomery()) {
+            ResidueKernels::multiply(level(), raw(r), raw(a), raw(b), n, context.getModulus(), context.getInverse());
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            raw(r)[i] = context.multiply(raw(a)[i], raw(b)[i]);
+        }
+    }
+
+    static void axpy(DynamicFinite *y, const DynamicFinite &k, const DynamicFinite *x, size_t n) {
+        const RuntimeReduction &context = reduction();
+        if (context.isMontgomery()) {
+            ResidueKernels::axpy(level(), raw(y), raw(&k)[0], raw(x), n, context.getModulus(), context.getInverse());
+            return;
+        }
+        uint32_t modulus = context.getModulus();
+        for (size_t i = 0; i < n; i++) {
+            uint32_t product = context.multiply(raw(&k)[0], raw(x)[i]);
+            raw(y)[i] = raw(y)[i] >= modulus - product ? raw(y)[i] - (modulus - product) : raw(y)[i] + product;
+        }
+    }
+
+    // r[i] *= k
+    static void scale(DynamicFinite *r, const DynamicFinite &k, size_t n) {
+        const RuntimeReduction &context = reduction();
+        for (size_t i = 0; i < n; i++) {
+            raw(r)[i] = context.multiply(raw(r)[i], raw(&k)[0]);
+        }
+    }
+
+    static DynamicFinite dot(const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        ResidueKernels::dot(level(), raw(a), raw(b), n, high, low);
+        DynamicFinite res(0);
+        raw(&res)[0] = reduction().reduceSum(high, low);
+        return res;
+    }
+
+private:
+    static const RuntimeReduction &reduction() {
+        return ModulusContext::current().getReduction();
+    }
+
+    static uint32_t *raw(DynamicFinite *a) {
+        return reinterpret_cast<uint32_t *>(a);
+    }
+
+    static const uint32_t *raw(const DynamicFinite *a) {
+        return reinterpret_cast<const uint32_t *>(a);
+    }
+};
+
+#endif //MATRIX_FINITE_KERNELS_H
@@ -0,0 +1,160 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-14.
+//
+
+#ifndef MATRIX_GREATEST_COMMON_DIVISOR_H
+#define MATRIX_GREATEST_COMMON_DIVISOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include "limb_arithmetic.h"
+#include "limb_vector.h"
+
+// GCD of magnitudes stored as limb arrays.
+// Long operands are reduced by Lehmer's algorithm: the quotient sequence is simulated on the leading
+// 62 bits and applied to the full numbers as one linear combination with single-word cofactors.
+// Once both operands fit in 64 bits the binary algorithm finishes the job.
+struct GreatestCommonDivisor {
+    typedef LimbArithmetic::Limb Limb;
+
+    // Leading bits used to simulate the Euclidean steps, the cofactors stay below 2^leadingBits
+    static constexpr int leadingBits = 62;
+
+    // Stein's binary GCD
+    static uint64_t binary(uint64_t a, uint64_t b) {
+        if (a == 0 || b == 0) {
+            return a | b;
+        }
+        int shift = __builtin_ctzll(a | b);
+        a >>= __builtin_ctzll(a);
+        while (b != 0) {
+            b >>= __builtin_ctzll(b);
+            if (a > b) {
+                std::swap(a, b);
+            }
+            b -= a;
+        }
+        return a << shift;
+    }
+
+    // gcd(a, b) for magnitudes a and b, leading zeros are allowed
+    static LimbVector compute(LimbVector a, LimbVector b) {
+        trim(a);
+        trim(b);
+        if (LimbArithmetic::compare(a.data(), a.size(), b.data(), b.size()) < 0) {
+            a.swap(b);
+        }
+
+        LimbVector nextA;
+        LimbVector nextB;
+        while (b.size() > 2) {
+            int64_t cofactorA, cofactorB, cofactorC, cofactorD;
+            simulate(a, b, cofactorA, cofactorB, cofactorC, cofactorD);
+
+            if (cofactorB == 0) {
+                // The leading bits could not even predict one quotient, make a full division step
+                remainder(a, b);
+                a.swap(b);
+                continue;
+            }
+
+            size_t n = a.size();
+            b.resize(n, 0);
+            nextA.resize(n);
+            nextB.resize(n);
+            combine(a.data(), b.data(), n, cofactorA, cofactorB, nextA.data());
+            combine(a.data(), b.data(), n, cofactorC, cofactorD, nextB.data());
+            a.swap(nextA);
+            b.swap(nextB);
+            trim(a);
+            trim(b);
+        }
+
+        if (b.empty()) {
+            return a;
+        }
+        remainder(a, b);
+        uint64_t result = binary(toUnsigned(a), toUnsigned(b));
+        return LimbVector{Limb(result), Limb(result >> LimbArithmetic::limbBits)};
+    }
+
+private:
+    static void trim(LimbVector &a) {
+        while (!a.empty() && a.back() == 0) {
+            a.pop_back();
+        }
+    }
+
+    static uint64_t toUnsigned(const LimbVector &a) {
+        uint64_t result = 0;
+        for (size_t i = a.size(); i > 0; i--) {
+            result = (result << LimbArithmetic::limbBits) | a[i - 1];
+        }
+        return result;
+    }
+
+    // a = a % b, b is not zero
+    static void remainder(LimbVector &a, const LimbVector &b) {
+        if (a.size() < b.size()) {
+            return;
+        }
+        LimbVector quotient(a.size() - b.size() + 1);
+        LimbVector rest(b.size());
+        LimbArithmetic::divide(a.data(), a.size(), b.data(), b.size(), quotient.data(), rest.data());
+        a.swap(rest);
+        trim(a);
+    }
+
+    // Knuth's Algorithm L on the leading bits of a >= b, at least three limbs each.
+    // Afterwards (A * a + B * b, C * a + D * b) is the pair the Euclidean algorithm would reach
+    static void simulate(const LimbVector &a, const LimbVector &b,
+                         int64_t &cofactorA, int64_t &cofactorB, int64_t &cofactorC, int64_t &cofactorD) {
+        size_t n = a.size();
+        int windowBits = 3 * LimbArithmetic::limbBits - __builtin_clz(a[n - 1]);
+        int shift = windowBits - leadingBits;
+        int64_t x = int64_t(leadingWindow(a, n) >> shift);
+        int64_t y = int64_t(leadingWindow(b, n) >> shift);
+
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        while (y + C != 0 && y + D != 0) {
+            int64_t quotient = (x + A) / (y + C);
+            if (quotient != (x + B) / (y + D)) {
+                break;
+            }
+            int64_t t = A - quotient * C;
+            A = C;
+            C = t;
+            t = B - quotient * D;
+            B = D;
+            D = t;
+            t = x - quotient * y;
+            x = y;
+            y = t;
+        }
+        cofactorA = A;
+        cofactorB = B;
+        cofactorC = C;
+        cofactorD = D;
+    }
+
+    // Limbs n-3..n-1 of a as one 96-bit number, a may be shorter than n limbs
+    static unsigned __int128 leadingWindow(const LimbVector &a, size_t n) {
+        unsigned __int128 window = 0;
+        for (size_t i = n; i > n - 3; i--) {
+            window = (window << LimbArithmetic::limbBits) | (i <= a.size() ? a[i - 1] : 0);
+        }
+        return window;
+    }
+
+    // r[0..n) = x * a[0..n) + y * b[0..n), the result must be non-negative and fit in n limbs
+    static void combine(const Limb *a, const Limb *b, size_t n, int64_t x, int64_t y, Limb *r) {
+        __int128 carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += (__int128) x * a[i] + (__int128) y * b[i];
+            r[i] = Limb(carry);
+            carry >>= LimbArithmetic::limbBits;
+        }
+    }
+};
+
+#endif //MATRIX_GREATEST_COMMON_DIVISOR_H
@@ -0,0 +1,545 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-01.
+//
+
+#ifndef MATRIX_LIMB_ARITHMETIC_H
+#define MATRIX_LIMB_ARITHMETIC_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "math_utils.h"
+#include "number_theoretic_transform.h"
+
+// Low-level kernels working on unsigned little-endian arrays of 32-bit limbs.
+// BigInteger keeps the sign separately and calls these on its magnitudes.
+struct LimbArithmetic {
+    typedef uint32_t Limb;
+    typedef uint64_t DoubleLimb;
+
+    static constexpr int limbBits = 32;
+    static constexpr DoubleLimb base = DoubleLimb(1) << limbBits;
+
+    // Operands shorter than this (in limbs) are multiplied by the schoolbook method
+    static inline size_t karatsubaThreshold = 40;
+
+    // Operands of at least this size (in limbs) are multiplied by Toom-3
+    static inline size_t toom3Threshold = 320;
+
+    // Operands of at least this size (in limbs) are multiplied via number-theoretic transforms
+    static inline size_t nttThreshold = 10240;
+
+    // NTT-friendly primes with primitive root 3, their product is about 2^86
+    static constexpr unsigned firstPrime = 998'244'353;
+    static constexpr unsigned secondPrime = 167'772'161;
+    static constexpr unsigned thirdPrime = 469'762'049;
+
+    // Each coefficient of a limb convolution is below min(n, m) * base^2 <= 2^85 for products of this length.
+    // Longer products are split into smaller ones first
+    static constexpr size_t maxNTTLength = size_t(1) << 22;
+
+    // Splitting smaller operands would not make the subproblems smaller
+    static constexpr size_t minimalSplitSize = 4;
+
+    // Division of operands this short uses a buffer on the stack
+    static constexpr size_t smallDivisionBuffer = 16;
+
+    // Compares a[0..n) and b[0..m) as numbers, leading zeros are allowed
+    static int compare(const Limb *a, size_t n, const Limb *b, size_t m) {
+        while (n > 0 && a[n - 1] == 0) {
+            n--;
+        }
+        while (m > 0 && b[m - 1] == 0) {
+            m--;
+        }
+        if (n != m) {
+            return n < m ? -1 : 1;
+        }
+        for (size_t i = n; i > 0; i--) {
+            if (a[i - 1] != b[i - 1]) {
+                return a[i - 1] < b[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // r[0..n) += a[0..m), m <= n. Returns the carry out of r[n - 1]
+    static Limb addTo(Limb *r, size_t n, const Limb *a, size_t m) {
+        DoubleLimb carry = 0;
+        size_t i = 0;
+        for (; i < m; i++) {
+            carry += (DoubleLimb) r[i] + a[i];
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+        for (; carry && i < n; i++) {
+            carry += r[i];
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+        return Limb(carry);
+    }
+
+    // r[0..n) -= a[0..m), m <= n. Returns the borrow out of r[n - 1]
+    static Limb subtractFrom(Limb *r, size_t n, const Limb *a, size_t m) {
+        DoubleLimb borrow = 0;
+        size_t i = 0;
+        for (; i < m; i++) {
+            DoubleLimb current = (DoubleLimb) r[i] - a[i] - borrow;
+            r[i] = Limb(current);
+            borrow = current >> (2 * limbBits - 1);
+        }
+        for (; borrow && i < n; i++) {
+            borrow = r[i] == 0 ? 1 : 0;
+            r[i]--;
+        }
+        return Limb(borrow);
+    }
+
+    // r[0..n) = a[0..n) - r[0..n), requires a >= r
+    static void subtractReversed(Limb *r, const Limb *a, size_t n) {
+        DoubleLimb borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            DoubleLimb current = (DoubleLimb) a[i] - r[i] - borrow;
+            r[i] = Limb(current);
+            borrow = current >> (2 * limbBits - 1);
+        }
+    }
+
+    // r[0..n) += a[0..m) * k, m <= n. Returns the carry out of r[n - 1]
+    static Limb addMultipleTo(Limb *r, size_t n, const Limb *a, size_t m, Limb k) {
+        DoubleLimb carry = 0;
+        size_t i = 0;
+        for (; i < m; i++) {
+            carry += r[i] + (DoubleLimb) a[i] * k;
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+        for (; carry && i < n; i++) {
+            carry += r[i];
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+        return Limb(carry);
+    }
+
+    // r[0..n+m) = a[0..n) * b[0..m)
+    static void multiplySchoolbook(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        std::fill(r, r + n + m, 0);
+        for (size_t i = 0; i < n; i++) {
+            if (a[i] == 0) {
+                continue;
+            }
+            DoubleLimb digitA = a[i];
+            DoubleLimb carry = 0;
+            for (size_t j = 0; j < m; j++) {
+                // (base - 1) + (base - 1)^2 + (base - 1) still fits into 64 bits
+                carry += r[i + j] + digitA * b[j];
+                r[i + j] = Limb(carry);
+                carry >>= limbBits;
+            }
+            r[i + m] = Limb(carry);
+        }
+    }
+
+    // r[0..n+m) = a[0..n) * b[0..m), n >= m > n / 2
+    static void multiplyKaratsuba(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        size_t h = n / 2;
+
+        // z0 = a0 * b0 goes to r[0..2h), z2 = a1 * b1 goes to r[2h..n+m)
+        multiply(a, h, b, h, r);
+        multiply(a + h, n - h, b + h, m - h, r + 2 * h);
+
+        std::vector<Limb> sumA(n - h + 1, 0);
+        std::copy(a + h, a + n, sumA.begin());
+        addTo(sumA.data(), sumA.size(), a, h);
+
+        std::vector<Limb> sumB(std::max(h, m - h) + 1, 0);
+        std::copy(b, b + h, sumB.begin());
+        addTo(sumB.data(), sumB.size(), b + h, m - h);
+
+        // z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+        std::vector<Limb> middle(sumA.size() + sumB.size());
+        multiply(sumA.data(), sumA.size(), sumB.data(), sumB.size(), middle.data());
+        subtractFrom(middle.data(), middle.size(), r, 2 * h);
+        subtractFrom(middle.data(), middle.size(), r + 2 * h, n + m - 2 * h);
+
+        size_t middleLength = middle.size();
+        while (middleLength > 0 && middle[middleLength - 1] == 0) {
+            middleLength--;
+        }
+        addTo(r + h, n + m - h, middle.data(), middleLength);
+    }
+
+    // r[0..n+m) = a[0..n) * b[0..m), n >= m, uses Toom-3 with Bodrato's interpolation sequence
+    static void multiplyToom3(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        size_t k = (n + 2) / 3;
+
+        SignedLimbs a0 = part(a, n, 0, k), a1 = part(a, n, k, k), a2 = part(a, n, 2 * k, k);
+        SignedLimbs b0 = part(b, m, 0, k), b1 = part(b, m, k, k), b2 = part(b, m, 2 * k, k);
+
+        // Evaluation at 0, 1, -1, -2 and infinity
+        SignedLimbs p = add(a0, a2);
+        SignedLimbs q = add(b0, b2);
+        SignedLimbs p1 = add(p, a1), pm1 = subtract(p, a1);
+        SignedLimbs q1 = add(q, b1), qm1 = subtract(q, b1);
+        SignedLimbs pm2 = subtract(multiplySmall(add(pm1, a2), 2), a0);
+        SignedLimbs qm2 = subtract(multiplySmall(add(qm1, b2), 2), b0);
+
+        SignedLimbs r0 = product(a0, b0);
+        SignedLimbs r1 = product(p1, q1);
+        SignedLimbs rm1 = product(pm1, qm1);
+        SignedLimbs rm2 = product(pm2, qm2);
+        SignedLimbs rInf = product(a2, b2);
+
+        // Interpolation
+        SignedLimbs r3 = divideSmallExact(subtract(rm2, r1), 3);
+        r1 = divideSmallExact(subtract(r1, rm1), 2);
+        SignedLimbs r2 = subtract(rm1, r0);
+        r3 = add(divideSmallExact(subtract(r2, r3), 2), multiplySmall(rInf, 2));
+        r2 = subtract(add(r2, r1), rInf);
+        r1 = subtract(r1, r3);
+
+        // All coefficients of the product polynomial are non-negative and fit into r
+        std::fill(r, r + n + m, 0);
+        const SignedLimbs *coefficients[] = {&r0, &r1, &r2, &r3, &rInf};
+        for (size_t i = 0; i < 5; i++) {
+            const std::vector<Limb> &limbs = coefficients[i]->limbs;
+            if (!limbs.empty()) {
+                addTo(r + i * k, n + m - i * k, limbs.data(), limbs.size());
+            }
+        }
+    }
+
+    // r[0..n+m) = a[0..n) * b[0..m), n + m <= maxNTTLength.
+    // The convolution is computed modulo three NTT-friendly primes and recombined by the Chinese remainder theorem
+    static void multiplyNTT(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        size_t length = 1;
+        while (length < n + m) {
+            length <<= 1;
+        }
+
+        std::vector<Finite<firstPrime>> r1 = NumberTheoreticTransform<firstPrime, 3>::convolve(a, n, b, m, length);
+        std::vector<Finite<secondPrime>> r2 = NumberTheoreticTransform<secondPrime, 3>::convolve(a, n, b, m, length);
+        std::vector<Finite<thirdPrime>> r3 = NumberTheoreticTransform<thirdPrime, 3>::convolve(a, n, b, m, length);
+
+        // Garner's algorithm: x = x1 + x2 * p1 + x3 * p1 * p2
+        const Finite<secondPrime> inverseP1(modPow(firstPrime % secondPrime, secondPrime - 2, secondPrime));
+        const Finite<thirdPrime> inverseP1P2(modPow(modMul(firstPrime, secondPrime, thirdPrime), thirdPrime - 2,
+                                                    thirdPrime));
+        const Finite<thirdPrime> p1(firstPrime % thirdPrime);
+
+        unsigned __int128 carry = 0;
+        for (size_t i = 0; i < n + m; i++) {
+            unsigned x1 = r1[i].getValue();
+            Finite<secondPrime> x2 = (r2[i] - Finite<secondPrime>(x1)) * inverseP1;
+            Finite<thirdPrime> x3 = (r3[i] - Finite<thirdPrime>(x1) - p1 * Finite<thirdPrime>(x2.getValue())) *
+                                    inverseP1P2;
+
+            carry += x1 + (DoubleLimb) x2.getValue() * firstPrime +
+                     (unsigned __int128) x3.getValue() * firstPrime * secondPrime;
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+    }
+
+    // r[0..n+m) = a[0..n) * b[0..m), picks the algorithm by the operand sizes
+    static void multiply(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        if (n < m) {
+            std::swap(a, b);
+            std::swap(n, m);
+        }
+        if (m == 0) {
+            std::fill(r, r + n, 0);
+            return;
+        }
+        if (m < std::max(karatsubaThreshold, minimalSplitSize)) {
+            multiplySchoolbook(a, n, b, m, r);
+            return;
+        }
+        if (m >= nttThreshold && n + m <= maxNTTLength) {
+            multiplyNTT(a, n, b, m, r);
+            return;
+        }
+        if (n >= 2 * m) {
+            multiplyUnbalanced(a, n, b, m, r);
+            return;
+        }
+        if (m < toom3Threshold) {
+            multiplyKaratsuba(a, n, b, m, r);
+        } else {
+            multiplyToom3(a, n, b, m, r);
+        }
+    }
+
+    // r[0..n) = a[0..n) * k, returns the carry. r may be the same array as a
+    static Limb multiplyBySmall(const Limb *a, size_t n, Limb k, Limb *r) {
+        DoubleLimb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            carry += (DoubleLimb) a[i] * k;
+            r[i] = Limb(carry);
+            carry >>= limbBits;
+        }
+        return Limb(carry);
+    }
+
+    // q[0..n) = a[0..n) / d, returns a[0..n) % d. q may be the same array as a
+    static Limb divideBySmall(const Limb *a, size_t n, Limb d, Limb *q) {
+        DoubleLimb remainder = 0;
+        for (size_t i = n; i > 0; i--) {
+            DoubleLimb current = (remainder << limbBits) | a[i - 1];
+            q[i - 1] = Limb(current / d);
+            remainder = current - q[i - 1] * (DoubleLimb) d;
+        }
+        return Limb(remainder);
+    }
+
+    // a[0..n) % d
+    static Limb remainderBySmall(const Limb *a, size_t n, Limb d) {
+        DoubleLimb remainder = 0;
+        for (size_t i = n; i > 0; i--) {
+            remainder = ((remainder << limbBits) | a[i - 1]) % d;
+        }
+        return Limb(remainder);
+    }
+
+    // Same as divideBySmall, but lets the compiler replace the division by a multiplication
+    template<Limb d>
+    static Limb divideByConstant(const Limb *a, size_t n, Limb *q) {
+        DoubleLimb remainder = 0;
+        for (size_t i = n; i > 0; i--) {
+            DoubleLimb current = (remainder << limbBits) | a[i - 1];
+            q[i - 1] = Limb(current / d);
+            remainder = current % d;
+        }
+        return Limb(remainder);
+    }
+
+    // r[0..n) = a[0..n) << shift, 0 <= shift < limbBits, returns the bits shifted out. r may be the same array as a
+    static Limb shiftLeft(const Limb *a, size_t n, int shift, Limb *r) {
+        if (shift == 0) {
+            std::copy(a, a + n, r);
+            return 0;
+        }
+        Limb carry = 0;
+        for (size_t i = 0; i < n; i++) {
+            Limb limb = a[i];
+            r[i] = (limb << shift) | carry;
+            carry = limb >> (limbBits - shift);
+        }
+        return carry;
+    }
+
+    // r[0..n) = a[0..n) >> shift, 0 <= shift < limbBits. r may be the same array as a
+    static void shiftRight(const Limb *a, size_t n, int shift, Limb *r) {
+        if (shift == 0) {
+            std::copy(a, a + n, r);
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            Limb high = i + 1 < n ? a[i + 1] << (limbBits - shift) : 0;
+            r[i] = (a[i] >> shift) | high;
+        }
+    }
+
+    // Knuth's Algorithm D: q[0..n-m+1) = a[0..n) / b[0..m), r[0..m) = a[0..n) % b[0..m).
+    // Requires n >= m > 0 and b[m - 1] != 0
+    static void divide(const Limb *a, size_t n, const Limb *b, size_t m, Limb *q, Limb *r) {
+        if (m == 1) {
+            r[0] = divideBySmall(a, n, b[0], q);
+            return;
+        }
+
+        // Normalization makes the top bit of the divisor set,
+        // so that the estimate from the top two limbs is off by at most two
+        int shift = __builtin_clz(b[m - 1]);
+        Limb stackBuffer[smallDivisionBuffer];
+        std::vector<Limb> heapBuffer(n + 1 + m <= smallDivisionBuffer ? 0 : n + 1 + m);
+        Limb *u = heapBuffer.empty() ? stackBuffer : heapBuffer.data();
+        Limb *v = u + n + 1;
+        u[n] = shiftLeft(a, n, shift, u);
+        shiftLeft(b, m, shift, v);
+
+        DoubleLimb topDivisor = v[m - 1];
+        DoubleLimb nextDivisor = v[m - 2];
+        for (size_t j = n - m + 1; j > 0; j--) {
+            Limb *window = u + j - 1;
+
+            DoubleLimb numerator = ((DoubleLimb) window[m] << limbBits) | window[m - 1];
+            DoubleLimb quotient = numerator / topDivisor;
+            DoubleLimb remainder = numerator - quotient * topDivisor;
+            while (quotient >= base || quotient * nextDivisor > ((remainder << limbBits) | window[m - 2])) {
+                quotient--;
+                remainder += topDivisor;
+                if (remainder >= base) {
+                    break;
+                }
+            }
+
+            // window[0..m] -= quotient * v
+            DoubleLimb carry = 0;
+            DoubleLimb borrow = 0;
+            for (size_t i = 0; i < m; i++) {
+                carry += quotient * v[i];
+                DoubleLimb current = (DoubleLimb) window[i] - Limb(carry) - borrow;
+                window[i] = Limb(current);
+                borrow = current >> (2 * limbBits - 1);
+                carry >>= limbBits;
+            }
+            DoubleLimb top = (DoubleLimb) window[m] - carry - borrow;
+            window[m] = Limb(top);
+
+            // The estimate was one too large, add the divisor back
+            if (top >> (2 * limbBits - 1)) {
+                quotient--;
+                window[m] += addTo(window, m, v, m);
+            }
+            q[j - 1] = Limb(quotient);
+        }
+
+        shiftRight(u, m, shift, r);
+    }
+
+    // q[0..n-m+1) = a[0..n) / b[0..m) for b dividing a, by Jebelean's right-to-left exact division.
+    // Once the divisor is made odd, every quotient limb is the low limb of the running remainder times
+    // b[0]^-1 mod 2^32, so there are no estimates and corrections, and the remainder is only kept
+    // to the length of the quotient. Requires n >= m > 0 and b[m - 1] != 0
+    static void divideExact(const Limb *a, size_t n, const Limb *b, size_t m, Limb *q) {
+        size_t quotientSize = n - m + 1;
+
+        // Zero limbs and bits at the bottom of b are at the bottom of a as well
+        size_t zeroLimbs = 0;
+        while (b[zeroLimbs] == 0) {
+            zeroLimbs++;
+        }
+        int shift = __builtin_ctz(b[zeroLimbs]);
+        size_t divisorSize = std::min(m - zeroLimbs, quotientSize);
+        std::vector<Limb> buffer(quotientSize + 1 + divisorSize + 1);
+        Limb *u = buffer.data();
+        Limb *v = u + quotientSize + 1;
+        size_t remainderLimbs = std::min(n - zeroLimbs, quotientSize + 1);
+        shiftRight(a + zeroLimbs, remainderLimbs, shift, u);
+        shiftRight(b + zeroLimbs, std::min(m - zeroLimbs, divisorSize + 1), shift, v);
+
+        // v[0] * inverse = 1 (mod 2^32), each Newton step doubles the number of correct low bits
+        Limb inverse = v[0];
+        for (int i = 0; i < 5; i++) {
+            inverse *= 2 - v[0] * inverse;
+        }
+
+        for (size_t i = 0; i < quotientSize; i++) {
+            Limb digit = u[i] * inverse;
+            q[i] = digit;
+            // u[i..quotientSize) -= digit * v, the borrow out of the top is dropped
+            size_t length = std::min(divisorSize, quotientSize - i);
+            DoubleLimb carry = 0;
+            DoubleLimb borrow = 0;
+            size_t j = 0;
+            for (; j < length; j++) {
+                carry += (DoubleLimb) digit * v[j];
+                DoubleLimb current = (DoubleLimb) u[i + j] - Limb(carry) - borrow;
+                u[i + j] = Limb(current);
+                borrow = current >> (2 * limbBits - 1);
+                carry >>= limbBits;
+            }
+            for (j += i; j < quotientSize && (carry || borrow); j++) {
+                DoubleLimb current = (DoubleLimb) u[j] - Limb(carry) - borrow;
+                u[j] = Limb(current);
+                borrow = current >> (2 * limbBits - 1);
+                carry >>= limbBits;
+            }
+        }
+    }
+
+private:
+    struct SignedLimbs {
+        std::vector<Limb> limbs;
+        bool negative = false;
+    };
+
+    static void trim(std::vector<Limb> &limbs) {
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+    }
+
+    static SignedLimbs part(const Limb *a, size_t n, size_t offset, size_t size) {
+        SignedLimbs res;
+        if (offset < n) {
+            res.limbs.assign(a + offset, a + std::min(n, offset + size));
+            trim(res.limbs);
+        }
+        return res;
+    }
+
+    static SignedLimbs add(const SignedLimbs &x, const SignedLimbs &y) {
+        SignedLimbs res;
+        if (x.negative == y.negative) {
+            const SignedLimbs &longer = x.limbs.size() >= y.limbs.size() ? x : y;
+            const SignedLimbs &shorter = x.limbs.size() >= y.limbs.size() ? y : x;
+            res.limbs = longer.limbs;
+            res.limbs.push_back(0);
+            addTo(res.limbs.data(), res.limbs.size(), shorter.limbs.data(), shorter.limbs.size());
+            res.negative = x.negative;
+        } else {
+            int cmp = compare(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size());
+            const SignedLimbs &larger = cmp >= 0 ? x : y;
+            const SignedLimbs &smaller = cmp >= 0 ? y : x;
+            res.limbs = larger.limbs;
+            subtractFrom(res.limbs.data(), res.limbs.size(), smaller.limbs.data(), smaller.limbs.size());
+            res.negative = larger.negative;
+        }
+        trim(res.limbs);
+        if (res.limbs.empty()) {
+            res.negative = false;
+        }
+        return res;
+    }
+
+    static SignedLimbs subtract(const SignedLimbs &x, SignedLimbs y) {
+        y.negative = !y.negative && !y.limbs.empty();
+        return add(x, y);
+    }
+
+    static SignedLimbs multiplySmall(SignedLimbs x, Limb k) {
+        Limb carry = multiplyBySmall(x.limbs.data(), x.limbs.size(), k, x.limbs.data());
+        if (carry) {
+            x.limbs.push_back(carry);
+        }
+        return x;
+    }
+
+    static SignedLimbs divideSmallExact(SignedLimbs x, Limb k) {
+        divideBySmall(x.limbs.data(), x.limbs.size(), k, x.limbs.data());
+        trim(x.limbs);
+        if (x.limbs.empty()) {
+            x.negative = false;
+        }
+        return x;
+    }
+
+    static SignedLimbs product(const SignedLimbs &x, const SignedLimbs &y) {
+        SignedLimbs res;
+        if (x.limbs.empty() || y.limbs.empty()) {
+            return res;
+        }
+        res.limbs.resize(x.limbs.size() + y.limbs.size());
+        multiply(x.limbs.data(), x.limbs.size(), y.limbs.data(), y.limbs.size(), res.limbs.data());
+        trim(res.limbs);
+        res.negative = x.negative != y.negative;
+        return res;
+    }
+
+    // Splits the longer operand into chunks of m limbs so that each partial product is balanced
+    static void multiplyUnbalanced(const Limb *a, size_t n, const Limb *b, size_t m, Limb *r) {
+        std::fill(r, r + n + m, 0);
+        std::vector<Limb> partial(2 * m);
+        for (size_t offset = 0; offset < n; offset += m) {
+            size_t size = std::min(m, n - offset);
+            multiply(a + offset, size, b, m, partial.data());
+            addTo(r + offset, n + m - offset, partial.data(), size + m);
+        }
+    }
+};
+
+#endif //MATRIX_LIMB_ARITHMETIC_H
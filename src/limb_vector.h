@@ -0,0 +1,188 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-11.
+//
+
+#ifndef MATRIX_LIMB_VECTOR_H
+#define MATRIX_LIMB_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include "limb_arithmetic.h"
+
+// Vector of limbs which keeps up to inlineCapacity limbs inside the object
+// and only goes to the heap for longer numbers
+class LimbVector {
+public:
+    typedef LimbArithmetic::Limb Limb;
+
+    static constexpr uint32_t inlineCapacity = 4;
+
+    LimbVector() : length(0), capacity(inlineCapacity) {}
+
+    explicit LimbVector(size_t n, Limb value = 0) : LimbVector() {
+        resize(n, value);
+    }
+
+    LimbVector(const Limb *begin, const Limb *end) : LimbVector() {
+        reserve(end - begin);
+        std::copy(begin, end, data());
+        length = uint32_t(end - begin);
+    }
+
+    LimbVector(std::initializer_list<Limb> limbs) : LimbVector(limbs.begin(), limbs.end()) {}
+
+    LimbVector(const LimbVector &other) : LimbVector(other.begin(), other.end()) {}
+
+    LimbVector(LimbVector &&other) noexcept: length(other.length), capacity(other.capacity) {
+        if (other.isInline()) {
+            std::copy(other.inlineLimbs, other.inlineLimbs + other.length, inlineLimbs);
+        } else {
+            heapLimbs = other.heapLimbs;
+            other.capacity = inlineCapacity;
+        }
+        other.length = 0;
+    }
+
+    ~LimbVector() {
+        if (!isInline()) {
+            delete[] heapLimbs;
+        }
+    }
+
+    LimbVector &operator=(const LimbVector &other) {
+        if (this != &other) {
+            length = 0;
+            reserve(other.length);
+            std::copy(other.begin(), other.end(), data());
+            length = other.length;
+        }
+        return *this;
+    }
+
+    LimbVector &operator=(LimbVector &&other) noexcept {
+        if (this != &other) {
+            swap(other);
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    Limb *data() {
+        return isInline() ? inlineLimbs : heapLimbs;
+    }
+
+    const Limb *data() const {
+        return isInline() ? inlineLimbs : heapLimbs;
+    }
+
+    Limb *begin() {
+        return data();
+    }
+
+    Limb *end() {
+        return data() + length;
+    }
+
+    const Limb *begin() const {
+        return data();
+    }
+
+    const Limb *end() const {
+        return data() + length;
+    }
+
+    Limb &operator[](size_t i) {
+        return data()[i];
+    }
+
+    Limb operator[](size_t i) const {
+        return data()[i];
+    }
+
+    Limb &back() {
+        return data()[length - 1];
+    }
+
+    Limb back() const {
+        return data()[length - 1];
+    }
+
+    // Keeps the current limbs
+    void reserve(size_t n) {
+        if (n <= capacity) {
+            return;
+        }
+        size_t newCapacity = std::max(n, size_t(capacity) * 2);
+        Limb *limbs = new Limb[newCapacity];
+        std::copy(begin(), end(), limbs);
+        if (!isInline()) {
+            delete[] heapLimbs;
+        }
+        heapLimbs = limbs;
+        capacity = uint32_t(newCapacity);
+    }
+
+    void resize(size_t n, Limb value = 0) {
+        reserve(n);
+        if (n > length) {
+            std::fill(data() + length, data() + n, value);
+        }
+        length = uint32_t(n);
+    }
+
+    void assign(size_t n, Limb value) {
+        length = 0;
+        resize(n, value);
+    }
+
+    void push_back(Limb limb) {
+        reserve(size_t(length) + 1);
+        data()[length++] = limb;
+    }
+
+    void pop_back() {
+        length--;
+    }
+
+    void swap(LimbVector &other) noexcept {
+        if (isInline() || other.isInline()) {
+            LimbVector &inlineOne = isInline() ? *this : other;
+            LimbVector &another = isInline() ? other : *this;
+            Limb limbs[inlineCapacity];
+            std::copy(inlineOne.inlineLimbs, inlineOne.inlineLimbs + inlineOne.length, limbs);
+            if (another.isInline()) {
+                std::copy(another.inlineLimbs, another.inlineLimbs + another.length, inlineOne.inlineLimbs);
+            } else {
+                inlineOne.heapLimbs = another.heapLimbs;
+            }
+            std::copy(limbs, limbs + inlineOne.length, another.inlineLimbs);
+        } else {
+            std::swap(heapLimbs, other.heapLimbs);
+        }
+        std::swap(length, other.length);
+        std::swap(capacity, other.capacity);
+    }
+
+private:
+    uint32_t length;
+    uint32_t capacity;
+    union {
+        Limb inlineLimbs[inlineCapacity];
+        Limb *heapLimbs;
+    };
+
+    bool isInline() const {
+        return capacity == inlineCapacity;
+    }
+};
+
+#endif //MATRIX_LIMB_VECTOR_H
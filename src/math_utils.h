@@ -5,53 +5,90 @@
 #ifndef MATRIX_MATH_UTILS_H
 #define MATRIX_MATH_UTILS_H
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
+#include "num_theory_template_tricks.h"
 
-bool isPrime(unsigned n) {
-    if (n < 2) {
-        return false;
+// Deterministic for every 64-bit n, see millerRabin
+bool isPrime(uint64_t n) {
+    return millerRabin(n);
+}
+
+// Finds first prime greater than n < 2^64 - 59. Only the residues coprime to 30 are tested
+uint64_t findNextPrime(uint64_t n) {
+    if (n < 7) {
+        do {
+            n++;
+        } while (!isPrime(n));
+        return n;
     }
-    int i = 2;
-    while (i * i <= n) {
-        if (n % i == 0) {
-            return false;
+    static const unsigned wheel[] = {1, 7, 11, 13, 17, 19, 23, 29};
+    uint64_t base = (n + 1) / 30 * 30;
+    size_t i = 0;
+    while (base + wheel[i] <= n || !isPrime(base + wheel[i])) {
+        if (++i == 8) {
+            i = 0;
+            base += 30;
         }
-        i++;
     }
-    return true;
+    return base + wheel[i];
 }
 
-// Finds all primes on [1 ; n] segment
-std::vector<unsigned> findPrimesOnSegment(unsigned n) {
-    std::vector<bool> prime(n + 1, true);
-    prime[0] = false;
-    prime[1] = false;
-    for (unsigned i = 2; i * i <= n; i++) {
-        if (prime[i]) {
-            for (unsigned j = i * i; j <= n; j += i) {
-                prime[j] = false;
+// The count smallest primes greater than n, for n + count * ln n below 2^64. Windows of odd numbers are
+// pre-sieved by the primes below 2^12, which leaves about 1 / 7 of them for Miller-Rabin
+std::vector<uint64_t> findNextPrimes(uint64_t n, size_t count) {
+    static const std::vector<unsigned> sievingPrimes = [] {
+        // Too few for PrimeSieve, which would tie this header to the thread pool
+        std::vector<unsigned> primes;
+        std::vector<bool> composite(1 << 12);
+        for (unsigned p = 2; p < composite.size(); p++) {
+            if (!composite[p]) {
+                primes.push_back(p);
+                for (unsigned m = p * p; m < composite.size(); m += p) {
+                    composite[m] = true;
+                }
             }
         }
-    }
+        return primes;
+    }();
+    // Primes are about ln n < 45 apart, so that a window usually covers all count of them
+    const size_t window = std::min(std::max(count * 32, size_t(1) << 10), size_t(1) << 15);
 
-    std::vector<unsigned> res;
-    for (unsigned i = 0; i <= n; i++) {
-        if (prime[i]) {
-            res.push_back(i);
+    std::vector<uint64_t> res;
+    res.reserve(count);
+    if (n < 2 && count > 0) {
+        res.push_back(2);
+    }
+    // lo + 2 i for i < window, lo odd
+    uint64_t lo = std::max(n + 1, uint64_t(3)) | 1;
+    std::vector<char> composite(window);
+    while (res.size() < count) {
+        std::fill(composite.begin(), composite.end(), 0);
+        for (size_t k = 1; k < sievingPrimes.size(); k++) {
+            uint64_t p = sievingPrimes[k];
+            if (p * p >= lo + 2 * window) {
+                break;
+            }
+            // The first odd multiple of p at least lo, p itself excluded
+            uint64_t first = std::max(p * p, (lo + p - 1) / p * p);
+            if (first % 2 == 0) {
+                first += p;
+            }
+            for (uint64_t j = (first - lo) / 2; j < window; j += p) {
+                composite[j] = 1;
+            }
+        }
+        for (size_t i = 0; i < window && res.size() < count; i++) {
+            if (!composite[i] && isPrime(lo + 2 * i)) {
+                res.push_back(lo + 2 * i);
+            }
         }
+        lo += 2 * window;
     }
     return res;
 }
 
-// Finds first prime greater than n
-unsigned findNextPrime(unsigned n) {
-    n++;
-    while (!isPrime(n)) {
-        n++;
-    }
-    return n;
-}
-
 // Finds a^n (mod m)
 unsigned modPow(unsigned a, unsigned n, unsigned m) {
     if (n == 0) {
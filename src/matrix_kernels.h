@@ -0,0 +1,497 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-19.
+//
+
+#ifndef MATRIX_MATRIX_KERNELS_H
+#define MATRIX_MATRIX_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "../include/BigInteger.h"
+#include "../include/DynamicFinite.h"
+#include "finite_kernels.h"
+#include "thread_pool.h"
+
+// Row operations the matrix kernels are built from, rows of Finite<M> and DynamicFinite go through
+// the vectorized residue kernels
+template<typename Field>
+struct RowOperations {
+    // y[0..n) += k * x[0..n)
+    static void axpy(Field *y, const Field &k, const Field *x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            y[i] += k * x[i];
+        }
+    }
+
+    // r[0..n) = a[0..n) + b[0..n), r may coincide with a or b
+    static void add(Field *r, const Field *a, const Field *b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] + b[i];
+        }
+    }
+
+    // r[0..n) = a[0..n) - b[0..n), r may coincide with a or b
+    static void subtract(Field *r, const Field *a, const Field *b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] = a[i] - b[i];
+        }
+    }
+
+    // r[0..n) *= k
+    static void scale(Field *r, const Field &k, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] *= k;
+        }
+    }
+};
+
+template<unsigned M>
+struct RowOperations<Finite<M>> {
+    static void axpy(Finite<M> *y, const Finite<M> &k, const Finite<M> *x, size_t n) {
+        FiniteKernels<M>::axpy(y, k, x, n);
+    }
+
+    static void add(Finite<M> *r, const Finite<M> *a, const Finite<M> *b, size_t n) {
+        FiniteKernels<M>::add(r, a, b, n);
+    }
+
+    static void subtract(Finite<M> *r, const Finite<M> *a, const Finite<M> *b, size_t n) {
+        FiniteKernels<M>::subtract(r, a, b, n);
+    }
+
+    static void scale(Finite<M> *r, const Finite<M> &k, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            r[i] *= k;
+        }
+    }
+};
+
+template<>
+struct RowOperations<DynamicFinite> {
+    static void axpy(DynamicFinite *y, const DynamicFinite &k, const DynamicFinite *x, size_t n) {
+        DynamicFiniteKernels::axpy(y, k, x, n);
+    }
+
+    static void add(DynamicFinite *r, const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        DynamicFiniteKernels::add(r, a, b, n);
+    }
+
+    static void subtract(DynamicFinite *r, const DynamicFinite *a, const DynamicFinite *b, size_t n) {
+        DynamicFiniteKernels::subtract(r, a, b, n);
+    }
+
+    static void scale(DynamicFinite *r, const DynamicFinite &k, size_t n) {
+        DynamicFiniteKernels::scale(r, k, n);
+    }
+};
+
+// Rings where division is only defined when it is exact, elimination over them has to be fraction-free
+template<typename Field>
+struct IsIntegerRing : std::false_type {
+};
+
+template<>
+struct IsIntegerRing<BigInteger> : std::true_type {
+};
+
+// Per-thread state a field depends on, carried into the tasks of the parallel kernels. Most fields have none
+template<typename Field>
+struct FieldContext {
+    struct Scope {
+        explicit Scope(const void *) {}
+    };
+
+    static const void *capture() {
+        return nullptr;
+    }
+};
+
+template<>
+struct FieldContext<DynamicFinite> {
+    typedef ModulusContext::Scope Scope;
+
+    static const ModulusContext *capture() {
+        return ModulusContext::currentOrNull();
+    }
+};
+
+// Kernels on row-major blocks given by a pointer to the first element and the distance between rows,
+// so that they work on whole matrices and on submatrices alike. Field only needs Field(0), Field(1)
+// and the arithmetic operators.
+// Large kernels split their work over ThreadPool::instance(). Every entry of the result is computed by
+// one task in the same order as in a single thread, so the results do not depend on the thread count
+template<typename Field>
+struct MatrixKernels {
+    // The tiled product walks c in blocks of tileRows x tileCols and the inner dimension in steps of tileDepth,
+    // so that the tileDepth x tileCols block of b stays in cache while it is used for tileRows rows of c
+    static inline size_t tileRows = 64;
+    static inline size_t tileDepth = 128;
+    static inline size_t tileCols = 256;
+
+    // Smallest number of field operations worth a task of its own
+    static inline size_t parallelGrain = 1 << 14;
+
+    // c[n x m] = a[n x k] * b[k x m] by the textbook triple loop, c must not overlap a or b
+    static void multiplyNaive(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                              Field *c, size_t cStride, size_t n, size_t k, size_t m) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < m; j++) {
+                Field sum(0);
+                for (size_t l = 0; l < k; l++) {
+                    sum += a[i * aStride + l] * b[l * bStride + j];
+                }
+                c[i * cStride + j] = sum;
+            }
+        }
+    }
+
+    // c[n x m] += a[n x k] * b[k x m] tile by tile. Inside a tile every a[i][l] is multiplied by a whole
+    // row segment of b, which is a contiguous axpy. Zero entries of a are skipped.
+    // The tiles of c are independent tasks
+    static void multiplyAdd(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                            Field *c, size_t cStride, size_t n, size_t k, size_t m) {
+        size_t rowTiles = (n + tileRows - 1) / tileRows;
+        size_t colTiles = (m + tileCols - 1) / tileCols;
+        size_t tileWork = std::max(size_t(1), std::min(n, tileRows) * k * std::min(m, tileCols));
+        parallelFor(0, rowTiles * colTiles, parallelGrain / tileWork + 1, [&](size_t lo, size_t hi) {
+            for (size_t tile = lo; tile < hi; tile++) {
+                size_t iBegin = tile / colTiles * tileRows;
+                size_t jBegin = tile % colTiles * tileCols;
+                multiplyTile(a, aStride, b, bStride, c, cStride, iBegin, std::min(n, iBegin + tileRows), k,
+                             jBegin, std::min(tileCols, m - jBegin));
+            }
+        });
+    }
+
+    // c[n x m] = a[n x k] * b[k x m], c must not overlap a or b
+    static void multiply(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                         Field *c, size_t cStride, size_t n, size_t k, size_t m) {
+        for (size_t i = 0; i < n; i++) {
+            std::fill(c + i * cStride, c + i * cStride + m, Field(0));
+        }
+        multiplyAdd(a, aStride, b, bStride, c, cStride, n, k, m);
+    }
+
+    // r = a + b on rows x cols blocks, r may coincide with a or b
+    static void add(Field *r, size_t rStride, const Field *a, size_t aStride, const Field *b, size_t bStride,
+                    size_t rows, size_t cols) {
+        forEachRow(rows, cols, [&](size_t i) {
+            RowOperations<Field>::add(r + i * rStride, a + i * aStride, b + i * bStride, cols);
+        });
+    }
+
+    // r = a - b on rows x cols blocks, r may coincide with a or b
+    static void subtract(Field *r, size_t rStride, const Field *a, size_t aStride, const Field *b, size_t bStride,
+                         size_t rows, size_t cols) {
+        forEachRow(rows, cols, [&](size_t i) {
+            RowOperations<Field>::subtract(r + i * rStride, a + i * aStride, b + i * bStride, cols);
+        });
+    }
+
+    // r *= k on a rows x cols block
+    static void scale(Field *r, size_t rStride, const Field &k, size_t rows, size_t cols) {
+        forEachRow(rows, cols, [&](size_t i) {
+            RowOperations<Field>::scale(r + i * rStride, k, cols);
+        });
+    }
+
+    // Products with every dimension above the cutoff are split by Strassen-Winograd
+    static inline size_t strassenCutoff = 128;
+
+    // c[n x m] = a[n x k] * b[k x m] with 7 half-size products instead of 8 per level of recursion.
+    // An odd dimension is peeled off: the even part goes through the recursion and the last row, column
+    // or rank-one term is done by the classical kernel. c must not overlap a or b.
+    // Only for exact fields, the extra additions make floating point errors grow faster
+    static void multiplyStrassen(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                                 Field *c, size_t cStride, size_t n, size_t k, size_t m) {
+        if (std::min({n, k, m}) <= strassenCutoff) {
+            multiply(a, aStride, b, bStride, c, cStride, n, k, m);
+            return;
+        }
+
+        size_t evenN = n & ~size_t(1), evenK = k & ~size_t(1), evenM = m & ~size_t(1);
+        winograd(a, aStride, b, bStride, c, cStride, evenN / 2, evenK / 2, evenM / 2);
+        if (k != evenK) {
+            multiplyAdd(a + evenK, aStride, b + evenK * bStride, bStride, c, cStride, evenN, 1, evenM);
+        }
+        if (m != evenM) {
+            // A single column is a matrix-vector product, row axpys of length one would only add overhead
+            multiplyNaive(a, aStride, b + evenM, bStride, c + evenM, cStride, n, k, 1);
+        }
+        if (n != evenN) {
+            multiply(a + evenN * aStride, aStride, b, bStride, c + evenN * cStride, cStride, 1, k, evenM);
+        }
+    }
+
+    // Gaussian elimination of a[rows x cols] to row echelon form. With reduced set, the pivots become 1
+    // and the pivot columns are cleared above the pivots as well. Returns the rank.
+    // determinant, if given, is multiplied by the determinant of the square part rows x rows; it turns to 0
+    // when that part is singular
+    static size_t eliminate(Field *a, size_t stride, size_t rows, size_t cols, bool reduced,
+                            Field *determinant = nullptr) {
+        const Field zero(0);
+        size_t rank = 0;
+        // The square part is non-singular only if every pivot lies on the diagonal
+        bool diagonalPivots = true;
+        for (size_t col = 0; col < cols && rank < rows; col++) {
+            size_t pivot = findPivot(a, stride, rows, rank, col);
+            if (pivot == rows) {
+                continue;
+            }
+            diagonalPivots = diagonalPivots && col == rank;
+
+            Field *pivotRow = a + rank * stride;
+            if (pivot != rank) {
+                std::swap_ranges(pivotRow + col, pivotRow + cols, a + pivot * stride + col);
+                if (determinant) {
+                    *determinant = zero - *determinant;
+                }
+            }
+            if (determinant) {
+                *determinant *= pivotRow[col];
+            }
+
+            // Exact fields take one inverse per pivot instead of a division per row,
+            // floating point ones divide to avoid the extra rounding
+            Field inverse = zero;
+            if (reduced || !std::is_floating_point<Field>::value) {
+                inverse = Field(1) / pivotRow[col];
+            }
+            if (reduced) {
+                for (size_t j = col; j < cols; j++) {
+                    pivotRow[j] *= inverse;
+                }
+            }
+
+            size_t pivotIndex = rank;
+            forEachRow(rows - (reduced ? 0 : rank + 1), cols - col, [&](size_t i) {
+                i += reduced ? 0 : pivotIndex + 1;
+                Field *row = a + i * stride;
+                if (i == pivotIndex || row[col] == zero) {
+                    return;
+                }
+                Field factor = zero;
+                if (reduced) {
+                    factor -= row[col];
+                } else if (std::is_floating_point<Field>::value) {
+                    factor -= row[col] / pivotRow[col];
+                } else {
+                    factor -= row[col] * inverse;
+                }
+                RowOperations<Field>::axpy(row + col, factor, pivotRow + col, cols - col);
+            });
+            rank++;
+        }
+
+        if (determinant && (rank < rows || !diagonalPivots)) {
+            *determinant = zero;
+        }
+        return rank;
+    }
+
+    // Bareiss' fraction-free elimination of a[rows x cols] to row echelon form, for integer rings.
+    // A step replaces a[i][j] by (p * a[i][j] - a[i][col] * a[r][j]) / q, where p is the pivot a[r][col]
+    // and q the previous pivot. The division is exact and every entry stays a minor of the original matrix,
+    // so the entries only grow linearly and no gcd is ever taken. Returns the rank.
+    // determinant, if given, is multiplied by the determinant of the square part rows x rows; it turns to 0
+    // when that part is singular
+    static size_t eliminateFractionFree(Field *a, size_t stride, size_t rows, size_t cols,
+                                        Field *determinant = nullptr) {
+        const Field zero(0);
+        Field previousPivot(1);
+        size_t rank = 0;
+        bool negate = false;
+        bool diagonalPivots = true;
+        for (size_t col = 0; col < cols && rank < rows; col++) {
+            size_t pivot = findPivot(a, stride, rows, rank, col);
+            if (pivot == rows) {
+                continue;
+            }
+            diagonalPivots = diagonalPivots && col == rank;
+
+            Field *pivotRow = a + rank * stride;
+            if (pivot != rank) {
+                std::swap_ranges(pivotRow + col, pivotRow + cols, a + pivot * stride + col);
+                negate = !negate;
+            }
+
+            size_t pivotIndex = rank;
+            forEachRow(rows - rank - 1, cols - col, [&](size_t i) {
+                Field *row = a + (pivotIndex + 1 + i) * stride;
+                for (size_t j = col + 1; j < cols; j++) {
+                    Field t = row[j] * pivotRow[col];
+                    multiplySubtract(t, row[col], pivotRow[j]);
+                    row[j] = exactQuotient(t, previousPivot);
+                }
+                row[col] = zero;
+            });
+            previousPivot = pivotRow[col];
+            rank++;
+        }
+
+        if (determinant) {
+            // The last pivot is the determinant of the rows swapped into place
+            if (rank < rows || !diagonalPivots) {
+                *determinant = zero;
+            } else {
+                *determinant *= negate ? zero - previousPivot : previousPivot;
+            }
+        }
+        return rank;
+    }
+
+private:
+    // t -= x * y
+    static void multiplySubtract(Field &t, const Field &x, const Field &y) {
+        if constexpr (std::is_same<Field, BigInteger>::value) {
+            submul(t, x, y);
+        } else {
+            t -= x * y;
+        }
+    }
+
+    // x / y for y dividing x
+    static Field exactQuotient(const Field &x, const Field &y) {
+        if constexpr (std::is_same<Field, BigInteger>::value) {
+            return divideExact(x, y);
+        } else {
+            return x / y;
+        }
+    }
+
+    // Row-major block of temporaries
+    struct Block {
+        std::vector<Field> elements;
+        size_t stride;
+
+        Block(size_t rows, size_t cols) : elements(rows * cols, Field(0)), stride(cols) {}
+
+        Field *data() {
+            return elements.data();
+        }
+    };
+
+    // ThreadPool::parallelFor with the field context of the calling thread installed in every task
+    template<typename F>
+    static void parallelFor(size_t begin, size_t end, size_t grain, F f) {
+        auto context = FieldContext<Field>::capture();
+        ThreadPool::instance().parallelFor(begin, end, grain, [&](size_t lo, size_t hi) {
+            typename FieldContext<Field>::Scope scope(context);
+            f(lo, hi);
+        });
+    }
+
+    // Calls f(i) for every row i < rows of a block, rows of cols elements each are split over the threads
+    template<typename F>
+    static void forEachRow(size_t rows, size_t cols, F f) {
+        parallelFor(0, rows, parallelGrain / std::max(cols, size_t(1)) + 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; i++) {
+                f(i);
+            }
+        });
+    }
+
+    // Rows [iBegin, iEnd) and columns [jBegin, jBegin + width) of c += a * b
+    static void multiplyTile(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                             Field *c, size_t cStride, size_t iBegin, size_t iEnd, size_t k,
+                             size_t jBegin, size_t width) {
+        const Field zero(0);
+        for (size_t lBegin = 0; lBegin < k; lBegin += tileDepth) {
+            size_t lEnd = std::min(k, lBegin + tileDepth);
+            for (size_t i = iBegin; i < iEnd; i++) {
+                Field *cRow = c + i * cStride + jBegin;
+                for (size_t l = lBegin; l < lEnd; l++) {
+                    const Field &factor = a[i * aStride + l];
+                    if (factor != zero) {
+                        RowOperations<Field>::axpy(cRow, factor, b + l * bStride + jBegin, width);
+                    }
+                }
+            }
+        }
+    }
+
+    // One level of the Winograd variant of Strassen's algorithm: 7 products and 15 additions of blocks.
+    // a is 2n x 2k, b is 2k x 2m, c is 2n x 2m; the products recurse through multiplyStrassen
+    static void winograd(const Field *a, size_t aStride, const Field *b, size_t bStride,
+                         Field *c, size_t cStride, size_t n, size_t k, size_t m) {
+        const Field *a11 = a, *a12 = a + k, *a21 = a + n * aStride, *a22 = a21 + k;
+        const Field *b11 = b, *b12 = b + m, *b21 = b + k * bStride, *b22 = b21 + m;
+        Field *c11 = c, *c12 = c + m, *c21 = c + n * cStride, *c22 = c21 + m;
+
+        Block s1(n, k), s2(n, k), s3(n, k), s4(n, k);
+        add(s1.data(), k, a21, aStride, a22, aStride, n, k);
+        subtract(s2.data(), k, s1.data(), k, a11, aStride, n, k);
+        subtract(s3.data(), k, a11, aStride, a21, aStride, n, k);
+        subtract(s4.data(), k, a12, aStride, s2.data(), k, n, k);
+
+        Block t1(k, m), t2(k, m), t3(k, m), t4(k, m);
+        subtract(t1.data(), m, b12, bStride, b11, bStride, k, m);
+        subtract(t2.data(), m, b22, bStride, t1.data(), m, k, m);
+        subtract(t3.data(), m, b22, bStride, b12, bStride, k, m);
+        subtract(t4.data(), m, t2.data(), m, b21, bStride, k, m);
+
+        // Four products go straight to the quadrants of c, which then accumulate the partial sums.
+        // The seven products are independent and run as separate tasks
+        Block p1(n, m), p4(n, m), p5(n, m);
+        parallelFor(0, 7, 1, [&](size_t lo, size_t hi) {
+            for (size_t product = lo; product < hi; product++) {
+                switch (product) {
+                    case 0:
+                        multiplyStrassen(a11, aStride, b11, bStride, p1.data(), m, n, k, m);
+                        break;
+                    case 1:
+                        multiplyStrassen(a12, aStride, b21, bStride, c11, cStride, n, k, m);
+                        break;
+                    case 2:
+                        multiplyStrassen(s4.data(), k, b22, bStride, c12, cStride, n, k, m);
+                        break;
+                    case 3:
+                        multiplyStrassen(a22, aStride, t4.data(), m, p4.data(), m, n, k, m);
+                        break;
+                    case 4:
+                        multiplyStrassen(s1.data(), k, t1.data(), m, p5.data(), m, n, k, m);
+                        break;
+                    case 5:
+                        multiplyStrassen(s2.data(), k, t2.data(), m, c22, cStride, n, k, m);
+                        break;
+                    default:
+                        multiplyStrassen(s3.data(), k, t3.data(), m, c21, cStride, n, k, m);
+                        break;
+                }
+            }
+        });
+
+        add(c11, cStride, c11, cStride, p1.data(), m, n, m);
+        add(c22, cStride, c22, cStride, p1.data(), m, n, m);
+        add(c21, cStride, c21, cStride, c22, cStride, n, m);
+        add(c22, cStride, c22, cStride, p5.data(), m, n, m);
+        add(c12, cStride, c12, cStride, c22, cStride, n, m);
+        add(c22, cStride, c21, cStride, p5.data(), m, n, m);
+        subtract(c21, cStride, c21, cStride, p4.data(), m, n, m);
+    }
+
+    // Exact fields take the first non-zero entry, floating point ones the largest in magnitude
+    static size_t findPivot(const Field *a, size_t stride, size_t rows, size_t from, size_t col) {
+        const Field zero(0);
+        size_t pivot = rows;
+        for (size_t i = from; i < rows; i++) {
+            const Field &x = a[i * stride + col];
+            if (x == zero) {
+                continue;
+            }
+            if constexpr (std::is_floating_point<Field>::value) {
+                if (pivot == rows || std::abs(x) > std::abs(a[pivot * stride + col])) {
+                    pivot = i;
+                }
+            } else {
+                return i;
+            }
+        }
+        return pivot;
+    }
+};
+
+#endif //MATRIX_MATRIX_KERNELS_H
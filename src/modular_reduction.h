@@ -0,0 +1,234 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-17.
+//
+
+#ifndef MATRIX_MODULAR_REDUCTION_H
+#define MATRIX_MODULAR_REDUCTION_H
+
+#include <cstdint>
+
+// Unsigned type twice as wide as Word, for the full products of the Montgomery reductions
+template<typename Word>
+struct DoubleWidth;
+
+template<>
+struct DoubleWidth<uint32_t> {
+    typedef uint64_t type;
+};
+
+template<>
+struct DoubleWidth<uint64_t> {
+    typedef unsigned __int128 type;
+};
+
+// m * inverse = 1 (mod 2^w) for an odd m and w-bit words. m itself is correct in the low 3 bits,
+// each Newton step doubles the number of correct low bits
+template<typename Word>
+constexpr Word montgomeryInverse(Word m) {
+    Word x = m;
+    for (int i = 0; i < 5; i++) {
+        x *= 2 - m * x;
+    }
+    return x;
+}
+
+// t * 2^-w mod m for t < m * 2^w. The low halves of t and q * m cancel, so the high halves are
+// subtracted directly and the (2w + 1)-bit sum t + q * m of the textbook version is never formed
+template<typename Word>
+constexpr Word montgomeryReduce(typename DoubleWidth<Word>::type t, Word m, Word inverse) {
+    typedef typename DoubleWidth<Word>::type Wide;
+    const int bits = 8 * sizeof(Word);
+    Word q = Word(t) * inverse;
+    Word high = Word(t >> bits);
+    Word correction = Word(((Wide) q * m) >> bits);
+    // m is added back by a mask rather than a branch, which mispredicts on random residues
+    return high - correction + (m & (0 - Word(high < correction)));
+}
+
+// x^-1 mod m by the extended Euclidean algorithm, x must be coprime to m
+constexpr uint32_t inverseModulo(uint32_t x, uint32_t m) {
+    int64_t a = x, b = m;
+    int64_t s = 1, t = 0;
+    while (b != 0) {
+        int64_t quotient = a / b;
+        int64_t r = a - quotient * b;
+        a = b;
+        b = r;
+        r = s - quotient * t;
+        s = t;
+        t = r;
+    }
+    return uint32_t(s < 0 ? s + m : s);
+}
+
+// Residues modulo an odd M < 2^32 in Montgomery form x * 2^32 mod M.
+// A product needs two multiplications instead of a 64-bit division
+template<unsigned M>
+struct MontgomeryReduction {
+    static_assert(M % 2 == 1, "Montgomery reduction needs an odd modulus");
+
+    static constexpr uint32_t inverse = montgomeryInverse(M);
+
+    // 2^64 mod M
+    static constexpr uint32_t r2 = uint32_t((((unsigned __int128) 1) << 64) % M);
+
+    static constexpr uint32_t reduce(uint64_t t) {
+        return montgomeryReduce(t, M, inverse);
+    }
+
+    static constexpr uint32_t toStorage(uint32_t x) {
+        return reduce((uint64_t) (x % M) * r2);
+    }
+
+    static constexpr uint32_t fromStorage(uint32_t x) {
+        return reduce(x);
+    }
+
+    static constexpr uint32_t multiply(uint32_t a, uint32_t b) {
+        return reduce((uint64_t) a * b);
+    }
+
+    // Same as reduce(high * 2^32 + low) for an unbounded sum of products, 2^32 * 2^-32 = 1
+    static constexpr uint32_t reduceSum(uint64_t high, uint64_t low) {
+        uint32_t x = uint32_t(high % M);
+        uint32_t y = reduce(low % M);
+        return x >= M - y ? x - (M - y) : x + y;
+    }
+};
+
+// Residues modulo an odd M < 2^64 in Montgomery form x * 2^64 mod M. The 128-bit products are single
+// mul (mulx with BMI2) instructions, so a product costs three multiplications as in MontgomeryReduction
+template<uint64_t M>
+struct MontgomeryReduction64 {
+    static_assert(M % 2 == 1, "Montgomery reduction needs an odd modulus");
+
+    static constexpr uint64_t inverse = montgomeryInverse(M);
+
+    // 2^64 mod M and 2^128 mod M
+    static constexpr uint64_t r = (0 - M) % M;
+    static constexpr uint64_t r2 = uint64_t((unsigned __int128) r * r % M);
+
+    static constexpr uint64_t reduce(unsigned __int128 t) {
+        return montgomeryReduce(t, M, inverse);
+    }
+
+    static constexpr uint64_t toStorage(uint64_t x) {
+        return reduce((unsigned __int128) (x % M) * r2);
+    }
+
+    static constexpr uint64_t fromStorage(uint64_t x) {
+        return reduce(x);
+    }
+
+    static constexpr uint64_t multiply(uint64_t a, uint64_t b) {
+        return reduce((unsigned __int128) a * b);
+    }
+};
+
+// Residues of an even modulus are kept as they are, the division by the constant M
+// is turned into a multiplication by the compiler
+template<unsigned M>
+struct PlainReduction {
+    static constexpr uint32_t toStorage(uint32_t x) {
+        return x % M;
+    }
+
+    static constexpr uint32_t fromStorage(uint32_t x) {
+        return x;
+    }
+
+    static constexpr uint32_t multiply(uint32_t a, uint32_t b) {
+        return uint32_t((uint64_t) a * b % M);
+    }
+
+    // x^-1 mod M for x coprime to M
+    static constexpr uint32_t invert(uint32_t x) {
+        return inverseModulo(x, M);
+    }
+
+    // (high * 2^32 + low) mod M
+    static constexpr uint32_t reduceSum(uint64_t high, uint64_t low) {
+        return uint32_t(((high % M) * ((uint64_t(1) << 32) % M) + low % M) % M);
+    }
+};
+
+// Reduction modulo a number known only at run time. The constants of MontgomeryReduction are computed once
+// per modulus and shared by all its residues. Even moduli keep plain residues and reduce by Barrett's method:
+// the quotient is estimated by a multiplication with floor((2^64 - 1) / M), off by at most 2
+class RuntimeReduction {
+public:
+    explicit RuntimeReduction(uint32_t modulus) :
+            modulus(modulus),
+            inverse(modulus % 2 == 1 ? montgomeryInverse(modulus) : 0),
+            r2(uint32_t((((unsigned __int128) 1) << 64) % modulus)),
+            r3(modulus % 2 == 1 ? montgomeryReduce((uint64_t) r2 * r2, modulus, inverse) : 0),
+            barrett(~uint64_t(0) / modulus) {}
+
+    uint32_t getModulus() const {
+        return modulus;
+    }
+
+    // Residues are stored in Montgomery form, only for odd moduli
+    bool isMontgomery() const {
+        return modulus % 2 == 1;
+    }
+
+    // M * inverse = 1 (mod 2^32), zero for an even modulus
+    uint32_t getInverse() const {
+        return inverse;
+    }
+
+    uint32_t toStorage(uint32_t x) const {
+        // x * r2 < M * 2^32 for any 32-bit x, there is no need to reduce x first
+        return isMontgomery() ? montgomeryReduce((uint64_t) x * r2, modulus, inverse) : reduce(x);
+    }
+
+    uint32_t fromStorage(uint32_t x) const {
+        return isMontgomery() ? montgomeryReduce(x, modulus, inverse) : x;
+    }
+
+    uint32_t multiply(uint32_t a, uint32_t b) const {
+        uint64_t t = (uint64_t) a * b;
+        return isMontgomery() ? montgomeryReduce(t, modulus, inverse) : reduce(t);
+    }
+
+    // The stored inverse of a stored residue. In Montgomery form x * R is inverted into x^-1 * R^-1,
+    // one more product with R^3 gives x^-1 * R
+    uint32_t invert(uint32_t x) const {
+        uint32_t res = inverseModulo(x, modulus);
+        return isMontgomery() ? montgomeryReduce((uint64_t) res * r3, modulus, inverse) : res;
+    }
+
+    // The stored residue of a sum of products of stored residues split as high * 2^32 + low,
+    // as in MontgomeryReduction::reduceSum and PlainReduction::reduceSum
+    uint32_t reduceSum(uint64_t high, uint64_t low) const {
+        uint32_t x = reduce(high);
+        uint32_t y = reduce(low);
+        if (isMontgomery()) {
+            y = montgomeryReduce(y, modulus, inverse);
+            return x >= modulus - y ? x - (modulus - y) : x + y;
+        }
+        // Below (M - 1)^2 + M < 2^64
+        return reduce((uint64_t) x * reduce(uint64_t(1) << 32) + y);
+    }
+
+private:
+    uint32_t modulus;
+    uint32_t inverse;
+    // 2^64 mod M and 2^96 mod M
+    uint32_t r2;
+    uint32_t r3;
+    uint64_t barrett;
+
+    // t mod M by Barrett's method
+    uint32_t reduce(uint64_t t) const {
+        uint64_t quotient = uint64_t(((unsigned __int128) t * barrett) >> 64);
+        uint64_t res = t - quotient * modulus;
+        while (res >= modulus) {
+            res -= modulus;
+        }
+        return uint32_t(res);
+    }
+};
+
+#endif //MATRIX_MODULAR_REDUCTION_H
@@ -0,0 +1,329 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-23.
+//
+
+#ifndef MATRIX_MULTI_MODULAR_H
+#define MATRIX_MULTI_MODULAR_H
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "../include/BigInteger.h"
+#include "../include/DynamicFinite.h"
+#include "../include/Rational.h"
+#include "math_utils.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+// Exact determinants and solutions of integer and rational systems from their images modulo word-size primes.
+// Every prime is an independent elimination over DynamicFinite, and the primes are spread over the threads.
+// The exact determinant is recovered by the Chinese remainder theorem once the product of the primes exceeds
+// twice the Hadamard bound. Solutions are recovered by rational reconstruction, which is tried as the product
+// grows and accepted when the candidate satisfies the system. Reconstruction is guaranteed to succeed once
+// the product exceeds 2 * max(N, D)^2 for the bounds N and D on Cramer's numerators and denominators
+struct MultiModular {
+    // Primes are taken upwards from here, so they lie in (2^30, 2^31) and products modulo them fit in 64 bits
+    static constexpr unsigned primesFrom = 1u << 30;
+
+    // Matrices of at least this size use the multi-modular method in Matrix::det() and solve()
+    static inline size_t threshold = 16;
+
+    static BigInteger determinant(const BigInteger *a, size_t stride, size_t n) {
+        size_t bound = hadamardBits(a, stride, n) + 1;
+        Reconstruction det(1);
+        size_t done = 0;
+        while (det.modulusBits() <= bound) {
+            size_t batch = batchSize();
+            std::vector<unsigned> primes = takePrimes(done, batch);
+            std::vector<unsigned> residues(batch);
+            ThreadPool::instance().parallelFor(0, batch, 1, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++) {
+                    residues[i] = determinantModulo(a, stride, n, primes[i]);
+                }
+            });
+            for (size_t i = 0; i < batch; i++) {
+                det.add(&residues[i], primes[i]);
+            }
+            done += batch;
+        }
+        return det.symmetric(0);
+    }
+
+    // Denominators are cleared row by row, which scales the determinant by their product
+    static Rational determinant(const Rational *a, size_t stride, size_t n) {
+        std::vector<BigInteger> integers(n * n);
+        BigInteger scale(1);
+        for (size_t i = 0; i < n; i++) {
+            scale *= clearDenominators(a + i * stride, n, integers.data() + i * n);
+        }
+        return Rational(determinant(integers.data(), n, n), scale);
+    }
+
+    // x[0..n) with a * x = b for an integer matrix a, false if a is singular
+    static bool solve(const BigInteger *a, size_t stride, size_t n, const BigInteger *b, Rational *x) {
+        // |det a| bounds the denominators, Hadamard's bound with b in place of one column bounds the numerators
+        size_t denominatorBits = hadamardBits(a, stride, n);
+        size_t numeratorBits = columnBits(b, 1, n);
+        for (size_t j = 0; j < n; j++) {
+            numeratorBits += columnBits(a + j, stride, n);
+        }
+        // reconstructRational finds |n|, d <= sqrt(m / 2), both have to fit under the larger bound
+        size_t bound = 2 * std::max(numeratorBits, denominatorBits) + 2;
+
+        Reconstruction solution(n);
+        size_t done = 0;
+        size_t unluckyBits = 0;
+        size_t nextAttempt = 1;
+        bool guaranteedTried = false;
+        while (true) {
+            size_t batch = batchSize();
+            std::vector<unsigned> primes = takePrimes(done, batch);
+            std::vector<unsigned> residues(batch * n);
+            std::vector<char> singular(batch);
+            ThreadPool::instance().parallelFor(0, batch, 1, [&](size_t lo, size_t hi) {
+                for (size_t i = lo; i < hi; i++) {
+                    singular[i] = !solveModulo(a, stride, n, b, primes[i], residues.data() + i * n);
+                }
+            });
+            done += batch;
+
+            for (size_t i = 0; i < batch; i++) {
+                if (singular[i]) {
+                    // Only primes dividing det a are singular, more of them than the bound allows means det a = 0
+                    unluckyBits += 30;
+                    if (unluckyBits > denominatorBits) {
+                        return false;
+                    }
+                } else {
+                    solution.add(residues.data() + i * n, primes[i]);
+                }
+            }
+
+            // Attempts at twice as many primes as the last time keep the total cost of reconstruction linear,
+            // one more attempt is made as soon as the product passes the bound
+            bool guaranteed = !guaranteedTried && solution.modulusBits() > bound;
+            if (solution.primes() >= nextAttempt || guaranteed) {
+                nextAttempt = 2 * solution.primes();
+                guaranteedTried = guaranteedTried || solution.modulusBits() > bound;
+                if (solution.reconstruct(x) && satisfies(a, stride, n, b, x)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    // Rows of [a | b] are scaled to integers, which does not change the solution
+    static bool solve(const Rational *a, size_t stride, size_t n, const Rational *b, Rational *x) {
+        std::vector<BigInteger> integers(n * n);
+        std::vector<BigInteger> right(n);
+        std::vector<Rational> row(n + 1);
+        std::vector<BigInteger> scaled(n + 1);
+        for (size_t i = 0; i < n; i++) {
+            std::copy(a + i * stride, a + i * stride + n, row.begin());
+            row[n] = b[i];
+            clearDenominators(row.data(), n + 1, scaled.data());
+            std::copy(scaled.begin(), scaled.begin() + n, integers.begin() + i * n);
+            right[i] = scaled[n];
+        }
+        return solve(integers.data(), n, n, right.data(), x);
+    }
+
+    // Finds n / d = u (mod m) with |n|, d <= sqrt(m / 2) by the half-extended Euclidean algorithm,
+    // false if there is no such fraction. 0 <= u < m
+    static bool reconstructRational(const BigInteger &u, const BigInteger &m, Rational &result) {
+        BigInteger r0 = m, r1 = u;
+        BigInteger t0(0), t1(1);
+        while (!withinHalf(r1, m)) {
+            std::pair<BigInteger, BigInteger> qr = divmod(r0, r1);
+            r0 = std::move(r1);
+            r1 = std::move(qr.second);
+            submul(t0, qr.first, t1);
+            std::swap(t0, t1);
+        }
+        if (t1 == 0 || !withinHalf(abs(t1), m)) {
+            return false;
+        }
+        result = Rational(r1, t1);
+        return true;
+    }
+
+private:
+    // Residues of several numbers modulo a growing product of primes, combined one prime at a time
+    class Reconstruction {
+    public:
+        explicit Reconstruction(size_t count) : values(count, BigInteger(0)), modulus(1) {}
+
+        // residues[i] is values[i] modulo prime
+        void add(const unsigned *residues, unsigned prime) {
+            ModulusContext context(prime);
+            ModulusContext::Scope scope(&context);
+            // values[i] += modulus * ((residues[i] - values[i]) / modulus mod prime)
+            DynamicFinite inverse = DynamicFinite(modulus.modulo(prime)).getInverse();
+            for (size_t i = 0; i < values.size(); i++) {
+                DynamicFinite step = (DynamicFinite(residues[i]) - DynamicFinite(values[i].modulo(prime))) * inverse;
+                addmul(values[i], modulus, BigInteger(step.getValue()));
+            }
+            modulus *= BigInteger(prime);
+            primeCount++;
+        }
+
+        size_t modulusBits() const {
+            return modulus.bitLength();
+        }
+
+        size_t primes() const {
+            return primeCount;
+        }
+
+        // The representative of values[i] in (-modulus / 2, modulus / 2]
+        BigInteger symmetric(size_t i) const {
+            return values[i] + values[i] <= modulus ? values[i] : values[i] - modulus;
+        }
+
+        bool reconstruct(Rational *x) const {
+            for (size_t i = 0; i < values.size(); i++) {
+                if (!reconstructRational(values[i], modulus, x[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        std::vector<BigInteger> values;
+        BigInteger modulus;
+        size_t primeCount = 0;
+    };
+
+    // 2 * x^2 <= m for x >= 0
+    static bool withinHalf(const BigInteger &x, const BigInteger &m) {
+        size_t bits = x.bitLength();
+        if (2 * bits + 1 < m.bitLength()) {
+            return true;
+        }
+        if (2 * bits > m.bitLength() + 1) {
+            return false;
+        }
+        BigInteger square = x * x;
+        return square + square <= m;
+    }
+
+    // Enough primes per batch to keep every thread busy
+    static size_t batchSize() {
+        return std::max(size_t(4), ThreadPool::instance().threadCount());
+    }
+
+    // Primes number from..from+count of the sequence, found once and shared by all callers
+    static std::vector<unsigned> takePrimes(size_t from, size_t count) {
+        static std::mutex mutex;
+        static std::vector<unsigned> primes;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (primes.size() < from + count) {
+            // At least doubling, so that the search runs a logarithmic number of times
+            size_t missing = std::max(from + count - primes.size(), primes.size());
+            for (uint64_t p : findNextPrimes(primes.empty() ? primesFrom : primes.back(), missing)) {
+                primes.push_back(unsigned(p));
+            }
+        }
+        return std::vector<unsigned>(primes.begin() + from, primes.begin() + from + count);
+    }
+
+    // Bits of an upper bound on the norm of a column of n entries
+    static size_t columnBits(const BigInteger *column, size_t stride, size_t n) {
+        BigInteger squares(0);
+        for (size_t i = 0; i < n; i++) {
+            addmul(squares, column[i * stride], column[i * stride]);
+        }
+        return (squares.bitLength() + 1) / 2;
+    }
+
+    // Bits of Hadamard's bound on |det a|, the product of the row norms
+    static size_t hadamardBits(const BigInteger *a, size_t stride, size_t n) {
+        size_t bits = 0;
+        for (size_t i = 0; i < n; i++) {
+            bits += columnBits(a + i * stride, 1, n);
+        }
+        return bits;
+    }
+
+    // Multiplies row[0..n) by the least common multiple of its denominators, which is returned
+    static BigInteger clearDenominators(const Rational *row, size_t n, BigInteger *result) {
+        BigInteger scale(1);
+        for (size_t j = 0; j < n; j++) {
+            const BigInteger &denominator = row[j].getDenominator();
+            scale *= divideExact(denominator, gcd(scale, denominator));
+        }
+        for (size_t j = 0; j < n; j++) {
+            result[j] = row[j].getNumerator() * divideExact(scale, row[j].getDenominator());
+        }
+        return scale;
+    }
+
+    static unsigned determinantModulo(const BigInteger *a, size_t stride, size_t n, unsigned prime) {
+        ModulusContext context(prime);
+        ModulusContext::Scope scope(&context);
+        std::vector<DynamicFinite> residues = reduce(a, stride, n, n, prime);
+        DynamicFinite det(1);
+        MatrixKernels<DynamicFinite>::eliminate(residues.data(), n, n, n, false, &det);
+        return det.getValue();
+    }
+
+    // x = a^-1 * b modulo prime by Gauss-Jordan elimination of [a | b], false if a is singular modulo prime
+    static bool solveModulo(const BigInteger *a, size_t stride, size_t n, const BigInteger *b, unsigned prime,
+                            unsigned *x) {
+        ModulusContext context(prime);
+        ModulusContext::Scope scope(&context);
+        std::vector<DynamicFinite> augmented(n * (n + 1), DynamicFinite(0));
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                augmented[i * (n + 1) + j] = DynamicFinite(a[i * stride + j].modulo(prime));
+            }
+            augmented[i * (n + 1) + n] = DynamicFinite(b[i].modulo(prime));
+        }
+        if (MatrixKernels<DynamicFinite>::eliminate(augmented.data(), n + 1, n, n + 1, true) < n ||
+            augmented[(n - 1) * (n + 1) + n - 1] == DynamicFinite(0)) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            x[i] = augmented[i * (n + 1) + n].getValue();
+        }
+        return true;
+    }
+
+    static std::vector<DynamicFinite> reduce(const BigInteger *a, size_t stride, size_t rows, size_t cols,
+                                             unsigned prime) {
+        std::vector<DynamicFinite> res;
+        res.reserve(rows * cols);
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < cols; j++) {
+                res.emplace_back(a[i * stride + j].modulo(prime));
+            }
+        }
+        return res;
+    }
+
+    // Checks a * x = b over the integers after bringing x to a common denominator
+    static bool satisfies(const BigInteger *a, size_t stride, size_t n, const BigInteger *b, const Rational *x) {
+        BigInteger denominator(1);
+        for (size_t i = 0; i < n; i++) {
+            const BigInteger &d = x[i].getDenominator();
+            denominator *= divideExact(d, gcd(denominator, d));
+        }
+        std::vector<BigInteger> y(n);
+        for (size_t i = 0; i < n; i++) {
+            y[i] = x[i].getNumerator() * divideExact(denominator, x[i].getDenominator());
+        }
+        for (size_t i = 0; i < n; i++) {
+            BigInteger sum = -(b[i] * denominator);
+            for (size_t j = 0; j < n; j++) {
+                addmul(sum, a[i * stride + j], y[j]);
+            }
+            if (sum != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif //MATRIX_MULTI_MODULAR_H
@@ -5,40 +5,126 @@
 #ifndef MATRIX_NUM_THEORY_TEMPLATE_TRICKS_H
 #define MATRIX_NUM_THEORY_TEMPLATE_TRICKS_H
 
-template<bool EXPR, typename T, typename F>
-struct TernaryOperator {
-    enum {
-        value = T::value
-    };
-};
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include "modular_reduction.h"
 
-template<typename T, typename F>
-struct TernaryOperator<false, T, F> {
-    enum {
-        value = F::value
-    };
-};
+// Miller-Rabin rounds for an odd n > 2 with every base below n, false as soon as a base proves n composite.
+// Powers are taken in Montgomery form, so a round needs no division once the constants are known
+template<typename Word>
+constexpr bool isStrongProbablePrime(Word n, std::initializer_list<uint64_t> bases) {
+    typedef typename DoubleWidth<Word>::type Wide;
+    Word d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s++;
+    }
+    Word inverse = montgomeryInverse(n);
+    // 2^w mod n and 2^2w mod n, the Montgomery forms of 1 and of 2^w
+    Word one = Word(0 - n) % n;
+    Word r2 = Word((Wide) one * one % n);
+    Word minusOne = n - one;
 
-template<bool V>
-struct BooleanValue {
-    enum {
-        value = V
-    };
-};
+    for (uint64_t base : bases) {
+        Word a = montgomeryReduce((Wide) Word(base) * r2, n, inverse);
+        Word x = one;
+        for (Word e = d; e > 0; e >>= 1) {
+            if (e & 1) {
+                x = montgomeryReduce((Wide) x * a, n, inverse);
+            }
+            a = montgomeryReduce((Wide) a * a, n, inverse);
+        }
+        bool witness = x != one && x != minusOne;
+        for (int i = 1; i < s && witness; i++) {
+            x = montgomeryReduce((Wide) x * x, n, inverse);
+            witness = x != minusOne;
+        }
+        if (witness) {
+            return false;
+        }
+    }
+    return true;
+}
 
-template<unsigned N, unsigned M>
-struct HasNonTrivialDivisors {
-    enum {
-        value = TernaryOperator<(N % M == 0), BooleanValue<false>,
-                TernaryOperator<(M * M <= N), HasNonTrivialDivisors<N, M + 1>, BooleanValue<true>>>::value
-    };
-};
+// Deterministic Miller-Rabin after trial division by the primes up to 37. The bases 2, 7, 61 have no
+// strong pseudoprime below 2^32, the seven bases found by Jim Sinclair have none below 2^64. A constant
+// expression, so a compile-time check costs a few hundred steps of constant evaluation instead of
+// sqrt(n) template instantiations
+constexpr bool millerRabin(uint64_t n) {
+    if (n < 2) {
+        return false;
+    }
+    for (uint64_t p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (n % p == 0) {
+            return n == p;
+        }
+    }
+    // Composites below 41^2 have a prime factor up to 37, and every base is below the remaining n
+    if (n < 41 * 41) {
+        return true;
+    }
+    if (n < (uint64_t(1) << 32)) {
+        return isStrongProbablePrime<uint32_t>(uint32_t(n), {2, 7, 61});
+    }
+    return isStrongProbablePrime<uint64_t>(n, {2, 325, 9375, 28178, 450775, 9780504, 1795265022});
+}
+
+// a^n for residues T such as Finite<M> by left-to-right sliding windows: every run of up to 3 exponent bits
+// that starts and ends with 1 costs one multiplication by a precomputed odd power, every bit one squaring.
+// With 2^(w - 1) odd powers and about k / (w + 1) multiplications for a k-bit exponent, w = 3 is the
+// cheapest for exponents of 20 to 64 bits. A loop, so it can be evaluated in a constant expression
+template<typename T>
+constexpr T slidingWindowPow(const T &a, unsigned long long n, const T &one) {
+    if (n == 0) {
+        return one;
+    }
+    // Short exponents do not pay for the table
+    const int width = n < 256 ? 1 : 3;
+    // odd[i] = a^(2i + 1)
+    T odd[4] = {a, a, a, a};
+    if (width > 1) {
+        T square = a;
+        square *= a;
+        for (int i = 1; i < (1 << (width - 1)); i++) {
+            odd[i] = odd[i - 1];
+            odd[i] *= square;
+        }
+    }
+
+    T res = one;
+    bool started = false;
+    for (int bit = 63 - __builtin_clzll(n); bit >= 0;) {
+        if (((n >> bit) & 1) == 0) {
+            res *= res;
+            bit--;
+            continue;
+        }
+        int low = std::max(bit - width + 1, 0);
+        while (((n >> low) & 1) == 0) {
+            low++;
+        }
+        unsigned window = unsigned(n >> low) & ((1u << (bit - low + 1)) - 1);
+        if (started) {
+            for (int i = low; i <= bit; i++) {
+                res *= res;
+            }
+            res *= odd[window / 2];
+        } else {
+            res = odd[window / 2];
+            started = true;
+        }
+        bit = low - 1;
+    }
+    return res;
+}
 
 // This structure was created for compile-time prime number check
-template<unsigned N>
+template<uint64_t N>
 struct IsPrime {
     enum {
-        value = TernaryOperator<(N < 2), BooleanValue<false>, HasNonTrivialDivisors<N, 2>>::value
+        value = millerRabin(N)
     };
 };
 
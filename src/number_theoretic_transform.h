@@ -0,0 +1,92 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-04.
+//
+
+#ifndef MATRIX_NUMBER_THEORETIC_TRANSFORM_H
+#define MATRIX_NUMBER_THEORETIC_TRANSFORM_H
+
+#include <algorithm>
+#include <vector>
+#include "../include/Finite.h"
+
+// Discrete Fourier transform over Z/MZ, M must be a prime of the form c * 2^k + 1
+// and G must be a primitive root modulo M
+template<unsigned M, unsigned G>
+struct NumberTheoreticTransform {
+
+    // The largest power of two dividing M - 1, i.e. the longest supported transform
+    static constexpr size_t maxLength = (size_t) ((M - 1) & -(M - 1));
+
+    // In-place transform, the size of a must be a power of two not exceeding maxLength
+    static void transform(std::vector<Finite<M>> &a, bool inverse) {
+        size_t n = a.size();
+        if (n == 1) {
+            return;
+        }
+
+        for (size_t i = 1, j = 0; i < n; i++) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(a[i], a[j]);
+            }
+        }
+
+        // roots[k] = w^k, where w is the principal n-th root of unity
+        Finite<M> root = Finite<M>::pow(Finite<M>(G), (M - 1) / n);
+        if (inverse) {
+            root = Finite<M>::pow(root, M - 2);
+        }
+        std::vector<Finite<M>> roots(n / 2, Finite<M>(1));
+        for (size_t k = 1; k < n / 2; k++) {
+            roots[k] = roots[k - 1] * root;
+        }
+
+        for (size_t length = 2; length <= n; length <<= 1) {
+            size_t half = length >> 1;
+            size_t step = n / length;
+            for (size_t i = 0; i < n; i += length) {
+                for (size_t j = 0; j < half; j++) {
+                    Finite<M> u = a[i + j];
+                    Finite<M> v = a[i + j + half] * roots[j * step];
+                    a[i + j] = u + v;
+                    a[i + j + half] = u - v;
+                }
+            }
+        }
+
+        if (inverse) {
+            Finite<M> inverseN = Finite<M>::pow(Finite<M>((unsigned) (n % M)), M - 2);
+            for (Finite<M> &x : a) {
+                x *= inverseN;
+            }
+        }
+    }
+
+    // Cyclic convolution of a[0..n) and b[0..m) of the given power of two length,
+    // every coefficient is taken modulo M
+    template<typename T>
+    static std::vector<Finite<M>> convolve(const T *a, size_t n, const T *b, size_t m, size_t length) {
+        std::vector<Finite<M>> fa(length, Finite<M>(0));
+        std::vector<Finite<M>> fb(length, Finite<M>(0));
+        for (size_t i = 0; i < n; i++) {
+            fa[i] = Finite<M>((unsigned) a[i]);
+        }
+        for (size_t i = 0; i < m; i++) {
+            fb[i] = Finite<M>((unsigned) b[i]);
+        }
+
+        transform(fa, false);
+        transform(fb, false);
+        for (size_t i = 0; i < length; i++) {
+            fa[i] *= fb[i];
+        }
+        transform(fa, true);
+        return fa;
+    }
+};
+
+#endif //MATRIX_NUMBER_THEORETIC_TRANSFORM_H
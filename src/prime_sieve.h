@@ -0,0 +1,236 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-27.
+//
+
+#ifndef MATRIX_PRIME_SIEVE_H
+#define MATRIX_PRIME_SIEVE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "thread_pool.h"
+
+// Segmented sieve of Eratosthenes over [lo, hi] with one bit per odd number. A segment of segmentBits odd
+// numbers fits in the L1 cache, so crossing off multiples never goes to memory however long the range is.
+// Primes below 64 hit every word, they are ORed in as precomputed periodic word patterns instead of bit by bit.
+// Segments are independent, in the parallel mode they are spread over the threads of the ThreadPool: a task
+// sieves consecutive segments and carries the next multiple of every prime from one segment to the next.
+// The default mode runs on the calling thread and never starts the pool
+class PrimeSieve {
+public:
+    // 2^18 bits are 32 KiB
+    static inline size_t segmentBits = size_t(1) << 18;
+
+    // All primes in [lo, hi] in increasing order
+    static std::vector<uint64_t> primesInRange(uint64_t lo, uint64_t hi, bool parallel = false) {
+        std::vector<std::vector<uint64_t>> segments;
+        run(lo, hi, parallel, [&](size_t segmentCount) {
+            segments.resize(segmentCount);
+        }, [&](size_t segment, uint64_t start, const std::vector<uint64_t> &composite, size_t bits) {
+            forEachPrime(start, composite, bits, [&](uint64_t p) {
+                segments[segment].push_back(p);
+            });
+        });
+
+        std::vector<uint64_t> res;
+        if (lo <= 2 && 2 <= hi) {
+            res.push_back(2);
+        }
+        for (const std::vector<uint64_t> &primes : segments) {
+            res.insert(res.end(), primes.begin(), primes.end());
+        }
+        return res;
+    }
+
+    // The number of primes in [lo, hi], without storing them
+    static uint64_t countPrimes(uint64_t lo, uint64_t hi, bool parallel = false) {
+        std::vector<uint64_t> counts;
+        run(lo, hi, parallel, [&](size_t segmentCount) {
+            counts.resize(segmentCount);
+        }, [&](size_t segment, uint64_t /*start*/, const std::vector<uint64_t> &composite, size_t bits) {
+            uint64_t count = 0;
+            for (size_t k = 0; k * 64 < bits; k++) {
+                count += __builtin_popcountll(~composite[k] & wordMask(bits - k * 64));
+            }
+            counts[segment] = count;
+        });
+
+        uint64_t res = lo <= 2 && 2 <= hi;
+        for (uint64_t count : counts) {
+            res += count;
+        }
+        return res;
+    }
+
+private:
+    static uint64_t squareRoot(uint64_t n) {
+        uint64_t r = uint64_t(std::sqrt((double) n));
+        while (r > 0 && (r > n / r)) {
+            r--;
+        }
+        while ((r + 1) <= n / (r + 1)) {
+            r++;
+        }
+        return r;
+    }
+
+    // Primes below this bound are sieved by word patterns
+    static constexpr uint64_t patternBound = 64;
+
+    // patterns()[p][r] has bit i set when p divides i + r, for odd p below patternBound and r < p
+    static const std::vector<std::vector<uint64_t>> &patterns() {
+        static const std::vector<std::vector<uint64_t>> res = [] {
+            std::vector<std::vector<uint64_t>> table(patternBound);
+            for (uint64_t p = 3; p < patternBound; p += 2) {
+                for (uint64_t r = 0; r < p; r++) {
+                    uint64_t word = 0;
+                    for (uint64_t i = (p - r) % p; i < 64; i += p) {
+                        word |= uint64_t(1) << i;
+                    }
+                    table[p].push_back(word);
+                }
+            }
+            return table;
+        }();
+        return res;
+    }
+
+    // The low min(bits, 64) bits
+    static uint64_t wordMask(size_t bits) {
+        return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    }
+
+    // The odd primes up to n, by a plain odd-only sieve for small n and by this one for larger n
+    static std::vector<uint64_t> sievingPrimes(uint64_t n, bool parallel) {
+        if (n > (uint64_t(1) << 24)) {
+            return primesInRange(3, n, parallel);
+        }
+        std::vector<uint64_t> res;
+        std::vector<bool> composite(n / 2 + 1);
+        for (uint64_t p = 3; p <= n; p += 2) {
+            if (composite[p / 2]) {
+                continue;
+            }
+            res.push_back(p);
+            for (uint64_t m = p * p; m <= n; m += 2 * p) {
+                composite[m / 2] = true;
+            }
+        }
+        return res;
+    }
+
+    // Calls f(p) for the primes of a sieved segment, the clear bits
+    template<typename F>
+    static void forEachPrime(uint64_t start, const std::vector<uint64_t> &composite, size_t bits, F f) {
+        for (size_t k = 0; k * 64 < bits; k++) {
+            uint64_t word = ~composite[k] & wordMask(bits - k * 64);
+            while (word != 0) {
+                f(start + 2 * (k * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    // Sieves the odd numbers of [lo, hi]. prepare(segmentCount) is called once, then
+    // visit(segment, start, composite, bits) for every segment, where bit i of composite stands for
+    // start + 2 i and only the first bits are meaningful. In the parallel mode visits of different segments
+    // may run concurrently
+    template<typename Prepare, typename Visit>
+    static void run(uint64_t lo, uint64_t hi, bool parallel, Prepare prepare, Visit visit) {
+        // 1 and 2 are left to the callers
+        uint64_t first = std::max(lo, uint64_t(3)) | 1;
+        if (first > hi) {
+            prepare(0);
+            return;
+        }
+        uint64_t odds = (hi - first) / 2 + 1;
+        size_t bitsPerSegment = std::max(segmentBits / 64, size_t(1)) * 64;
+        size_t segmentCount = size_t((odds + bitsPerSegment - 1) / bitsPerSegment);
+        prepare(segmentCount);
+        std::vector<uint64_t> primes = sievingPrimes(squareRoot(hi), parallel);
+
+        const std::vector<std::vector<uint64_t>> &pattern = patterns();
+        // The primes up to small go through the patterns
+        size_t small = 0;
+        while (small < primes.size() && primes[small] < patternBound) {
+            small++;
+        }
+
+        auto sieve = [&](size_t begin, size_t end) {
+            size_t words = bitsPerSegment / 64;
+            std::vector<uint64_t> composite(words);
+            // Bit of the next odd multiple of every prime relative to the current segment, for the small
+            // primes the pattern of the first word
+            std::vector<uint64_t> next(primes.size());
+            uint64_t start = first + 2 * uint64_t(begin) * bitsPerSegment;
+            for (size_t k = 0; k < primes.size(); k++) {
+                uint64_t p = primes[k];
+                uint64_t multiple = std::max(p * p, (start + p - 1) / p * p);
+                if (multiple % 2 == 0) {
+                    multiple += p;
+                }
+                next[k] = (multiple - start) / 2;
+                if (k < small) {
+                    next[k] = (p - next[k] % p) % p;
+                }
+            }
+
+            for (size_t segment = begin; segment < end; segment++) {
+                size_t bits = size_t(std::min(uint64_t(bitsPerSegment), odds - uint64_t(segment) * bitsPerSegment));
+                std::fill(composite.begin(), composite.end(), 0);
+                for (size_t k = 0; k < small; k++) {
+                    uint64_t p = primes[k];
+                    uint64_t step = 64 % p;
+                    uint64_t r = next[k];
+                    for (size_t w = 0; w < words; w++) {
+                        composite[w] |= pattern[p][r];
+                        r += step;
+                        r = r >= p ? r - p : r;
+                    }
+                    next[k] = r;
+                    // The pattern also crosses off p itself
+                    if (start <= p && p < start + 2 * uint64_t(bitsPerSegment)) {
+                        uint64_t j = (p - start) / 2;
+                        composite[j / 64] &= ~(uint64_t(1) << (j % 64));
+                    }
+                }
+                for (size_t k = small; k < primes.size(); k++) {
+                    uint64_t p = primes[k];
+                    uint64_t j = next[k];
+                    for (; j < bitsPerSegment; j += p) {
+                        composite[j / 64] |= uint64_t(1) << (j % 64);
+                    }
+                    next[k] = j - bitsPerSegment;
+                }
+                visit(segment, start, composite, bits);
+                start += 2 * uint64_t(bitsPerSegment);
+            }
+        };
+        // A single segment is not worth a task
+        if (parallel && segmentCount > 1) {
+            ThreadPool::instance().parallelFor(0, segmentCount, 1, sieve);
+        } else {
+            sieve(0, segmentCount);
+        }
+    }
+};
+
+// All primes in [lo, hi], see PrimeSieve. parallel spreads the segments over the ThreadPool
+std::vector<uint64_t> primesInRange(uint64_t lo, uint64_t hi, bool parallel = false) {
+    return PrimeSieve::primesInRange(lo, hi, parallel);
+}
+
+// The number of primes in [lo, hi]
+uint64_t countPrimesInRange(uint64_t lo, uint64_t hi, bool parallel = false) {
+    return PrimeSieve::countPrimes(lo, hi, parallel);
+}
+
+// Finds all primes on [1 ; n] segment
+std::vector<unsigned> findPrimesOnSegment(unsigned n) {
+    std::vector<uint64_t> primes = primesInRange(1, n);
+    return std::vector<unsigned>(primes.begin(), primes.end());
+}
+
+#endif //MATRIX_PRIME_SIEVE_H
@@ -0,0 +1,223 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-21.
+//
+
+#ifndef MATRIX_THREAD_POOL_H
+#define MATRIX_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing scheduler behind the parallel kernels. Every worker owns a deque: it takes its own tasks
+// from the back and, when that is empty, steals the oldest task from the front of another deque.
+// A thread waiting for its parallelFor runs queued tasks while there are any, so kernels may nest, and
+// sleeps until its last chunk finishes once the deques are empty.
+// Results never depend on the thread count as long as the chunks of a parallelFor write disjoint data
+class ThreadPool {
+public:
+    // The pool shared by all kernels, started with one thread per hardware thread
+    static ThreadPool &instance() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    explicit ThreadPool(size_t threads) {
+        start(threads);
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        stop();
+    }
+
+    // Threads taking part in a parallelFor, the calling one included. Must not be called while tasks run
+    void setThreadCount(size_t threads) {
+        stop();
+        start(std::max(size_t(1), threads));
+    }
+
+    size_t threadCount() const {
+        return workers.size() + 1;
+    }
+
+    // Calls f(lo, hi) on consecutive chunks of [begin, end) of at least grain elements each and returns
+    // once all of them are done. The first exception thrown by a chunk is rethrown here
+    template<typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F f) {
+        if (begin >= end) {
+            return;
+        }
+        size_t length = end - begin;
+        grain = std::max(grain, size_t(1));
+        // A few chunks per thread leave room for stealing when the chunks take different time
+        size_t chunks = std::min((length + grain - 1) / grain, 4 * threadCount());
+        if (chunks <= 1 || workers.empty()) {
+            f(begin, end);
+            return;
+        }
+
+        Job job;
+        job.remaining = chunks;
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            size_t lo = begin + length * chunk / chunks;
+            size_t hi = begin + length * (chunk + 1) / chunks;
+            push([&job, &f, lo, hi]() {
+                std::exception_ptr error;
+                try {
+                    f(lo, hi);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                // Notified under the lock: the waiter only sees remaining == 0 after the unlock,
+                // so job is not destroyed while this chunk still uses it
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (error && !job.error) {
+                    job.error = error;
+                }
+                if (--job.remaining == 0) {
+                    job.done.notify_all();
+                }
+            });
+        }
+
+        while (!job.finished()) {
+            if (!runOne()) {
+                // The remaining chunks are running on other threads, the last one wakes this one up
+                std::unique_lock<std::mutex> lock(job.mutex);
+                job.done.wait(lock, [&job]() { return job.remaining == 0; });
+            }
+        }
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    typedef std::function<void()> Task;
+
+    // A parallelFor in progress, remaining and error are guarded by mutex
+    struct Job {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = 0;
+        std::exception_ptr error;
+
+        bool finished() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return remaining == 0;
+        }
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> nextWorker{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopping = false;
+
+    // Index of the worker running on this thread in the pool it belongs to
+    static inline thread_local const ThreadPool *currentPool = nullptr;
+    static inline thread_local size_t currentWorker = 0;
+
+    void start(size_t threads) {
+        stopping = false;
+        for (size_t i = 0; i + 1 < threads; i++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->thread = std::thread([this, i]() { work(i); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        sleepCondition.notify_all();
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread.join();
+        }
+        workers.clear();
+    }
+
+    bool isWorkerThread() const {
+        return currentPool == this;
+    }
+
+    // Tasks of a worker go to its own deque, tasks of other threads are spread over all deques
+    void push(Task task) {
+        size_t index = isWorkerThread() ? currentWorker : nextWorker++ % workers.size();
+        {
+            // Counted first, so that pending never drops below the number of queued tasks
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            pending++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers[index]->mutex);
+            workers[index]->tasks.push_back(std::move(task));
+        }
+        sleepCondition.notify_one();
+    }
+
+    // Runs the newest task of the own deque or the oldest one of another deque, false if there is none
+    bool runOne() {
+        Task task;
+        size_t self = isWorkerThread() ? currentWorker : 0;
+        for (size_t i = 0; i < workers.size() && !task; i++) {
+            Worker &victim = *workers[(self + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) {
+                continue;
+            }
+            if (isWorkerThread() && i == 0) {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+            } else {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        pending--;
+        task();
+        return true;
+    }
+
+    void work(size_t index) {
+        currentPool = this;
+        currentWorker = index;
+        while (true) {
+            if (runOne()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.wait(lock, [this]() { return stopping || pending != 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+};
+
+#endif //MATRIX_THREAD_POOL_H
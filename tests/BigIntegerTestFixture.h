@@ -0,0 +1,133 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-01.
+//
+
+#ifndef MATRIX_BIG_INTEGER_TEST_FIXTURE_H
+#define MATRIX_BIG_INTEGER_TEST_FIXTURE_H
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include "../include/BigInteger.h"
+
+class BigIntegerTestFixture : public ::testing::Test {
+public:
+    std::mt19937 rnd;
+
+    // Random number with exactly the given amount of decimal digits
+    BigInteger randomBigInteger(size_t decimalDigits, bool allowNegative = true) {
+        std::string s(decimalDigits, '0');
+        for (char &c : s) {
+            c = char('0' + rnd() % 10);
+        }
+        s[0] = char('1' + rnd() % 9);
+        if (allowNegative && rnd() % 2 == 0) {
+            s = "-" + s;
+        }
+        return BigInteger(s);
+    }
+
+    // Multiplies a and b using the schoolbook kernel only
+    BigInteger referenceProduct(const BigInteger &a, const BigInteger &b) {
+        size_t karatsubaThreshold = LimbArithmetic::karatsubaThreshold;
+        size_t toom3Threshold = LimbArithmetic::toom3Threshold;
+        size_t nttThreshold = LimbArithmetic::nttThreshold;
+        LimbArithmetic::karatsubaThreshold = SIZE_MAX;
+        LimbArithmetic::toom3Threshold = SIZE_MAX;
+        LimbArithmetic::nttThreshold = SIZE_MAX;
+
+        BigInteger res = a * b;
+
+        LimbArithmetic::karatsubaThreshold = karatsubaThreshold;
+        LimbArithmetic::toom3Threshold = toom3Threshold;
+        LimbArithmetic::nttThreshold = nttThreshold;
+        return res;
+    }
+
+    void testMultiplication(size_t karatsubaThreshold, size_t toom3Threshold, size_t nttThreshold, size_t maxDigits) {
+        LimbArithmetic::karatsubaThreshold = karatsubaThreshold;
+        LimbArithmetic::toom3Threshold = toom3Threshold;
+        LimbArithmetic::nttThreshold = nttThreshold;
+
+        for (int t = 0; t < 100; t++) {
+            BigInteger a = randomBigInteger(1 + rnd() % maxDigits);
+            BigInteger b = randomBigInteger(1 + rnd() % maxDigits);
+            ASSERT_EQ(a * b, referenceProduct(a, b));
+        }
+    }
+
+    // Converts s to BigInteger and back with the given split threshold, the result must be the same as without splitting
+    void checkDecimalConversion(const std::string &s, size_t splitThreshold) {
+        BigInteger::decimalSplitThreshold = SIZE_MAX;
+        BigInteger expected(s);
+        std::string expectedString = expected.toString();
+
+        BigInteger::decimalSplitThreshold = splitThreshold;
+        BigInteger a(s);
+        ASSERT_EQ(a, expected);
+        ASSERT_EQ(a.toString(), expectedString);
+    }
+
+    void checkDivision(const BigInteger &a, const BigInteger &b) {
+        std::pair<BigInteger, BigInteger> qr = divmod(a, b);
+        ASSERT_EQ(qr.first * b + qr.second, a);
+        ASSERT_LT(abs(qr.second), abs(b));
+        if (qr.second != 0) {
+            ASSERT_EQ(qr.second.getSign(), a.getSign());
+        }
+    }
+
+    void testDivision(size_t maxDigitsA, size_t maxDigitsB) {
+        for (int t = 0; t < 200; t++) {
+            BigInteger a = randomBigInteger(1 + rnd() % maxDigitsA);
+            BigInteger b = randomBigInteger(1 + rnd() % maxDigitsB);
+            checkDivision(a, b);
+        }
+    }
+
+    void checkExactDivision(const BigInteger &q, const BigInteger &b) {
+        ASSERT_EQ(divideExact(q * b, b), q);
+        if (q != 0) {
+            ASSERT_EQ(divideExact(q * b, q * b), BigInteger(1));
+        }
+    }
+
+    // Euclidean algorithm on full divisions
+    BigInteger referenceGcd(BigInteger a, BigInteger b) {
+        a = abs(a);
+        b = abs(b);
+        while (b != 0) {
+            a %= b;
+            std::swap(a, b);
+        }
+        return a;
+    }
+
+    void checkGcd(const BigInteger &a, const BigInteger &b) {
+        BigInteger expected = referenceGcd(a, b);
+        ASSERT_EQ(gcd(a, b), expected);
+        ASSERT_EQ(gcd(b, a), expected);
+    }
+
+protected:
+    size_t savedKaratsubaThreshold = 0;
+    size_t savedToom3Threshold = 0;
+    size_t savedNTTThreshold = 0;
+    size_t savedDecimalSplitThreshold = 0;
+
+    void SetUp() override {
+        savedDecimalSplitThreshold = BigInteger::decimalSplitThreshold;
+        savedKaratsubaThreshold = LimbArithmetic::karatsubaThreshold;
+        savedToom3Threshold = LimbArithmetic::toom3Threshold;
+        savedNTTThreshold = LimbArithmetic::nttThreshold;
+    }
+
+    void TearDown() override {
+        BigInteger::decimalSplitThreshold = savedDecimalSplitThreshold;
+        LimbArithmetic::karatsubaThreshold = savedKaratsubaThreshold;
+        LimbArithmetic::toom3Threshold = savedToom3Threshold;
+        LimbArithmetic::nttThreshold = savedNTTThreshold;
+    }
+};
+
+#endif //MATRIX_BIG_INTEGER_TEST_FIXTURE_H
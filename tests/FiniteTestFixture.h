@@ -6,8 +6,12 @@
 #define MATRIX_FINITE_TEST_FIXTURE_H
 
 #include <gtest/gtest.h>
+#include <numeric>
 #include <random>
+#include "../include/Finite64.h"
+#include "../src/finite_kernels.h"
 #include "../src/math_utils.h"
+#include "../src/prime_sieve.h"
 
 class FiniteTestFixture : public ::testing::Test {
 public:
@@ -30,6 +34,12 @@ public:
                 unsigned power = rnd();
 
                 ASSERT_EQ(Finite<M>::pow(number, power).getValue(), modPow(a, power, M));
+                // exponents below 256 skip the window table
+                ASSERT_EQ(Finite<M>::pow(number, power % 300).getValue(), modPow(a, power % 300, M));
+                // a^(power * 2^32 + power) = (a^power)^(2^32) * a^power
+                unsigned long long wide = (unsigned long long) power << 32 | power;
+                ASSERT_EQ(Finite<M>::pow(number, wide),
+                          Finite<M>::pow(Finite<M>::pow(number, power), 1ull << 32) * Finite<M>::pow(number, power));
             }
         }
     }
@@ -67,6 +77,156 @@ public:
         }
     }
 
+    // Compares every kernel on every instruction set level with the scalar operators of Finite
+    template<unsigned M>
+    void testKernels() {
+        std::mt19937 rnd;
+        for (size_t n : {0, 1, 7, 8, 15, 16, 17, 33, 100, 1000}) {
+            std::vector<Finite<M>> a, b;
+            for (size_t i = 0; i < n; i++) {
+                // residues next to 0 and M - 1 catch wrong carries
+                a.emplace_back(i % 5 == 0 ? M - 1 - i % 3 : rnd());
+                b.emplace_back(i % 7 == 0 ? i % 3 : rnd());
+            }
+            Finite<M> k(rnd());
+
+            for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+                FiniteKernels<M>::levelLimit = level;
+                std::vector<Finite<M>> r(n, Finite<M>(0));
+
+                FiniteKernels<M>::add(r.data(), a.data(), b.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i].getValue(), (a[i] + b[i]).getValue());
+                }
+                FiniteKernels<M>::subtract(r.data(), a.data(), b.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i].getValue(), (a[i] - b[i]).getValue());
+                }
+                FiniteKernels<M>::multiply(r.data(), a.data(), b.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i].getValue(), (a[i] * b[i]).getValue());
+                }
+
+                std::vector<Finite<M>> y = b;
+                FiniteKernels<M>::axpy(y.data(), k, a.data(), n);
+                Finite<M> expectedDot(0);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(y[i].getValue(), (b[i] + k * a[i]).getValue());
+                    expectedDot += a[i] * b[i];
+                }
+                ASSERT_EQ(FiniteKernels<M>::dot(a.data(), b.data(), n).getValue(), expectedDot.getValue());
+
+                // the result may be one of the operands
+                r = a;
+                FiniteKernels<M>::add(r.data(), r.data(), r.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i].getValue(), (a[i] + a[i]).getValue());
+                }
+            }
+            FiniteKernels<M>::levelLimit = SimdLevel::AVX512;
+        }
+    }
+
+    // DynamicFinite modulo M against Finite<M>: operators, pow, inverses and the kernels on every level
+    template<unsigned M>
+    void testDynamic() {
+        ModulusContext context(M);
+        ModulusContext::Scope scope(&context);
+        ASSERT_EQ(DynamicFinite::getModulus(), M);
+
+        std::mt19937 rnd;
+        std::vector<Finite<M>> a, b;
+        std::vector<DynamicFinite> x, y;
+        for (size_t i = 0; i < 100; i++) {
+            unsigned first = i % 5 == 0 ? M - 1 - i % 3 : rnd();
+            unsigned second = i % 7 == 0 ? i % 3 : rnd();
+            a.emplace_back(first);
+            b.emplace_back(second);
+            x.emplace_back(first);
+            y.emplace_back(second);
+        }
+
+        for (size_t i = 0; i < a.size(); i++) {
+            ASSERT_EQ(x[i].getValue(), a[i].getValue());
+            ASSERT_EQ((x[i] + y[i]).getValue(), (a[i] + b[i]).getValue());
+            ASSERT_EQ((x[i] - y[i]).getValue(), (a[i] - b[i]).getValue());
+            ASSERT_EQ((x[i] * y[i]).getValue(), (a[i] * b[i]).getValue());
+            unsigned power = rnd();
+            ASSERT_EQ(DynamicFinite::pow(x[i], power).getValue(), Finite<M>::pow(a[i], power).getValue());
+            if (x[i].getValue() != 0 && std::gcd(x[i].getValue(), M) == 1) {
+                ASSERT_EQ((x[i] * x[i].getInverse()).getValue(), 1u % M);
+                ASSERT_EQ((y[i] / x[i] * x[i]).getValue(), y[i].getValue());
+            }
+        }
+
+        DynamicFinite k(rnd());
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::AVX2, SimdLevel::AVX512}) {
+            DynamicFiniteKernels::levelLimit = level;
+            for (size_t n : {0, 1, 15, 17, 100}) {
+                std::vector<DynamicFinite> r(n, DynamicFinite(0));
+                DynamicFiniteKernels::add(r.data(), x.data(), y.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i], x[i] + y[i]);
+                }
+                DynamicFiniteKernels::subtract(r.data(), x.data(), y.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i], x[i] - y[i]);
+                }
+                DynamicFiniteKernels::multiply(r.data(), x.data(), y.data(), n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i], x[i] * y[i]);
+                }
+
+                r.assign(y.begin(), y.begin() + n);
+                DynamicFiniteKernels::axpy(r.data(), k, x.data(), n);
+                DynamicFinite expectedDot(0);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i], y[i] + k * x[i]);
+                    expectedDot += x[i] * y[i];
+                }
+                ASSERT_EQ(DynamicFiniteKernels::dot(x.data(), y.data(), n), expectedDot);
+
+                DynamicFiniteKernels::scale(r.data(), k, n);
+                for (size_t i = 0; i < n; i++) {
+                    ASSERT_EQ(r[i], (y[i] + k * x[i]) * k);
+                }
+            }
+        }
+        DynamicFiniteKernels::levelLimit = SimdLevel::AVX512;
+    }
+
+    // Finite64<M> against 128-bit arithmetic, residues next to 0 and M - 1 included
+    template<uint64_t M>
+    void testFinite64() {
+        typedef unsigned __int128 Wide;
+        std::mt19937_64 rnd;
+        for (size_t i = 0; i < 1000; i++) {
+            uint64_t a = i % 5 == 0 ? M - 1 - i % 3 : rnd() % M;
+            uint64_t b = i % 7 == 0 ? i % 3 : rnd() % M;
+            Finite64<M> x(a), y(b);
+            ASSERT_EQ(x.getValue(), a);
+            ASSERT_EQ((x + y).getValue(), uint64_t(((Wide) a + b) % M));
+            ASSERT_EQ((x - y).getValue(), uint64_t(((Wide) a + M - b) % M));
+            ASSERT_EQ((x * y).getValue(), uint64_t((Wide) a * b % M));
+
+            unsigned long long power = rnd() >> (i % 64);
+            uint64_t expected = 1 % M;
+            for (int bit = 63; bit >= 0; bit--) {
+                expected = uint64_t((Wide) expected * expected % M);
+                if ((power >> bit) & 1) {
+                    expected = uint64_t((Wide) expected * a % M);
+                }
+            }
+            ASSERT_EQ(Finite64<M>::pow(x, power).getValue(), expected);
+            if constexpr (IS_PRIME(M)) {
+                if (a != 0) {
+                    ASSERT_EQ((x * x.getInverse()).getValue(), 1u);
+                    ASSERT_EQ((y / x * x).getValue(), b);
+                }
+            }
+        }
+    }
+
 protected:
 
     // Here we generate about 2000 prime numbers and 2000 composite numbers
@@ -75,8 +235,8 @@ protected:
 
         // Adding big primes
         primeNumbers.push_back(1'000'000'007);
-        for (int i = 0; i < 1000; i++) {
-            primeNumbers.push_back(findNextPrime(primeNumbers.back()));
+        for (uint64_t p : findNextPrimes(primeNumbers.back(), 1000)) {
+            primeNumbers.push_back(unsigned(p));
         }
 
         std::mt19937 rnd;
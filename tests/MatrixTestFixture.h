@@ -0,0 +1,248 @@
+//
+// Created by Ярослав Гамаюнов on 2020-03-19.
+//
+
+#ifndef MATRIX_MATRIX_TEST_FIXTURE_H
+#define MATRIX_MATRIX_TEST_FIXTURE_H
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../include/Matrix.h"
+
+class MatrixTestFixture : public ::testing::Test {
+public:
+    std::mt19937 rnd;
+
+    template<typename Field>
+    Field randomElement() {
+        if constexpr (std::is_same<Field, Rational>::value) {
+            return Rational(BigInteger(int(rnd() % 41) - 20), BigInteger(int(rnd() % 9) + 1));
+        } else if constexpr (std::is_floating_point<Field>::value) {
+            return Field(int(rnd() % 2001) - 1000) / 64;
+        } else {
+            return Field(rnd());
+        }
+    }
+
+    template<unsigned Rows, unsigned Cols, typename Field>
+    Matrix<Rows, Cols, Field> randomMatrix() {
+        Matrix<Rows, Cols, Field> res;
+        for (size_t i = 0; i < Rows; i++) {
+            for (size_t j = 0; j < Cols; j++) {
+                res[i][j] = randomElement<Field>();
+            }
+        }
+        return res;
+    }
+
+    // The tiled product with tiny and odd tiles and Strassen with tiny cutoffs must agree with the triple loop
+    // on every shape
+    template<typename Field, unsigned N, unsigned K, unsigned M>
+    void checkProduct() {
+        typedef MatrixKernels<Field> Kernels;
+        Matrix<N, K, Field> a = randomMatrix<N, K, Field>();
+        Matrix<K, M, Field> b = randomMatrix<K, M, Field>();
+        Matrix<N, M, Field> expected;
+        Kernels::multiplyNaive(a.data(), K, b.data(), M, expected.data(), M, N, K, M);
+        ASSERT_TRUE(a * b == expected);
+
+        size_t tileRows = Kernels::tileRows, tileDepth = Kernels::tileDepth, tileCols = Kernels::tileCols;
+        Kernels::tileRows = 3;
+        Kernels::tileDepth = 5;
+        Kernels::tileCols = 7;
+        Matrix<N, M, Field> tiled = a * b;
+        Kernels::tileRows = tileRows;
+        Kernels::tileDepth = tileDepth;
+        Kernels::tileCols = tileCols;
+        ASSERT_TRUE(tiled == expected);
+
+        if constexpr (!std::is_floating_point<Field>::value) {
+            size_t cutoff = Kernels::strassenCutoff;
+            for (size_t smallCutoff : {1, 2, 5}) {
+                Kernels::strassenCutoff = smallCutoff;
+                Matrix<N, M, Field> strassen;
+                Kernels::multiplyStrassen(a.data(), K, b.data(), M, strassen.data(), M, N, K, M);
+                ASSERT_TRUE(strassen == expected);
+            }
+            Kernels::strassenCutoff = cutoff;
+        }
+    }
+
+    // Products of random factors of rank r have rank r, the inverse of a non-singular matrix gives E,
+    // and the determinant is multiplicative
+    template<typename Field, unsigned N>
+    void checkElimination() {
+        typedef SquareMatrix<N, Field> Square;
+        Square a = randomMatrix<N, N, Field>();
+        Square b = randomMatrix<N, N, Field>();
+        ASSERT_TRUE((a * b).det() == a.det() * b.det());
+
+        ASSERT_NE(a.det(), Field(0));
+        ASSERT_EQ(a.rank(), N);
+        ASSERT_TRUE(a * a.inverted() == Square::identity());
+        ASSERT_TRUE(a.inverted() * a == Square::identity());
+
+        for (unsigned r = 0; r < N; r += 3) {
+            Matrix<N, N, Field> left, right;
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = 0; j < r; j++) {
+                    left[i][j] = randomElement<Field>();
+                    right[j][i] = randomElement<Field>();
+                }
+            }
+            Square product = left * right;
+            ASSERT_EQ(product.rank(), r);
+            ASSERT_EQ(product.det(), Field(0));
+        }
+    }
+
+    // Bareiss over integers against Gaussian elimination over rationals on the same matrix. Columns whose
+    // index is a multiple of zeroColumnStep are cleared and rank rank is forced through a product
+    template<unsigned Rows, unsigned Cols>
+    void checkFractionFree(size_t rank, size_t zeroColumnStep, int entryBits) {
+        Matrix<Rows, Cols, BigInteger> left, right, a;
+        Matrix<Rows, Cols, Rational> rationalA;
+        for (size_t i = 0; i < Rows; i++) {
+            for (size_t l = 0; l < rank; l++) {
+                left[i][l] = (BigInteger(int(rnd() % 2001) - 1000) << (rnd() % entryBits));
+            }
+        }
+        for (size_t l = 0; l < rank; l++) {
+            for (size_t j = 0; j < Cols; j++) {
+                right[l][j] = j % zeroColumnStep == 0 ? BigInteger(0) : BigInteger(int(rnd() % 2001) - 1000);
+            }
+        }
+        for (size_t i = 0; i < Rows; i++) {
+            for (size_t j = 0; j < Cols; j++) {
+                for (size_t l = 0; l < rank; l++) {
+                    a[i][j] += left[i][l] * right[l][j];
+                }
+                rationalA[i][j] = Rational(a[i][j]);
+            }
+        }
+
+        ASSERT_EQ(a.rank(), rationalA.rank());
+        ASSERT_LE(a.rank(), rank);
+        if constexpr (Rows == Cols) {
+            ASSERT_EQ(Rational(a.det()), rationalA.det());
+        }
+
+        // Rows below the rank vanish and the leading entries move right
+        Matrix<Rows, Cols, BigInteger> echelon = a.echelonForm();
+        size_t previousLead = 0;
+        for (size_t i = 0; i < Rows; i++) {
+            size_t lead = 0;
+            while (lead < Cols && echelon[i][lead] == 0) {
+                lead++;
+            }
+            ASSERT_EQ(lead == Cols, i >= a.rank());
+            if (i > 0 && lead < Cols) {
+                ASSERT_GT(lead, previousLead);
+            }
+            previousLead = lead;
+        }
+    }
+
+    // Random n x n integer matrix of rank r with entries of about entryBits bits
+    template<unsigned N>
+    SquareMatrix<N, BigInteger> randomIntegerMatrix(size_t rank, int entryBits) {
+        SquareMatrix<N, BigInteger> left, right;
+        for (size_t i = 0; i < N; i++) {
+            for (size_t l = 0; l < rank; l++) {
+                left[i][l] = BigInteger(int(rnd() % 2001) - 1000) << (rnd() % entryBits);
+                right[l][i] = BigInteger(int(rnd() % 2001) - 1000);
+            }
+        }
+        return left * right;
+    }
+
+    // Determinants and solutions by the multi-modular method against Bareiss and Gauss-Jordan over rationals
+    template<unsigned N>
+    void checkMultiModular(size_t rank, int entryBits) {
+        SquareMatrix<N, BigInteger> a = randomIntegerMatrix<N>(rank, entryBits);
+        Matrix<N, 1, BigInteger> b;
+        SquareMatrix<N, Rational> rationalA;
+        Matrix<N, 1, Rational> rationalB;
+        for (size_t i = 0; i < N; i++) {
+            b[i][0] = BigInteger(int(rnd() % 2001) - 1000) << (rnd() % entryBits);
+            rationalB[i][0] = Rational(b[i][0], BigInteger(int(rnd() % 9) + 1));
+            for (size_t j = 0; j < N; j++) {
+                rationalA[i][j] = Rational(a[i][j], BigInteger(int(rnd() % 9) + 1));
+            }
+        }
+
+        SquareMatrix<N, BigInteger> copy = a;
+        BigInteger expected(1);
+        MatrixKernels<BigInteger>::eliminateFractionFree(copy.data(), N, N, N, &expected);
+        ASSERT_EQ(MultiModular::determinant(a.data(), N, N), expected);
+
+        Matrix<N, 1, Rational> x;
+        ASSERT_EQ(solve(a, b, x), rank == N);
+        if (rank == N) {
+            for (size_t i = 0; i < N; i++) {
+                Rational sum(0);
+                for (size_t j = 0; j < N; j++) {
+                    sum += Rational(a[i][j]) * x[j][0];
+                }
+                ASSERT_EQ(sum, Rational(b[i][0]));
+            }
+        }
+
+        size_t threshold = MultiModular::threshold;
+        MultiModular::threshold = SIZE_MAX;
+        Rational rationalDet = rationalA.det();
+        Matrix<N, 1, Rational> expectedX;
+        bool solvable = solve(rationalA, rationalB, expectedX);
+        MultiModular::threshold = 0;
+        ASSERT_EQ(rationalA.det(), rationalDet);
+        ASSERT_EQ(solve(rationalA, rationalB, x), solvable);
+        MultiModular::threshold = threshold;
+        if (solvable) {
+            ASSERT_TRUE(x == expectedX);
+        }
+    }
+
+    // Every kernel split into the smallest tasks on several threads must give the single-threaded result
+    template<typename Field, unsigned N>
+    void checkThreadCountIndependence() {
+        typedef MatrixKernels<Field> Kernels;
+        typedef SquareMatrix<N, Field> Square;
+        Square a = randomMatrix<N, N, Field>();
+        Square b = randomMatrix<N, N, Field>();
+        Field k = randomElement<Field>();
+
+        auto compute = [&]() {
+            size_t cutoff = Kernels::strassenCutoff;
+            Kernels::strassenCutoff = 4;
+            std::vector<Square> res = {a * b, a + b, a - b, a * k, a.inverted()};
+            Kernels::strassenCutoff = cutoff;
+            Square tiled;
+            Kernels::multiply(a.data(), N, b.data(), N, tiled.data(), N, N, N, N);
+            res.push_back(tiled);
+            Square det;
+            det[0][0] = a.det();
+            det[0][1] = Field(a.rank());
+            res.push_back(det);
+            return res;
+        };
+
+        ThreadPool &pool = ThreadPool::instance();
+        size_t threads = pool.threadCount();
+        size_t grain = Kernels::parallelGrain;
+        pool.setThreadCount(1);
+        std::vector<Square> expected = compute();
+        pool.setThreadCount(5);
+        Kernels::parallelGrain = 1;
+        std::vector<Square> parallel = compute();
+        Kernels::parallelGrain = grain;
+        pool.setThreadCount(threads);
+
+        ASSERT_EQ(expected.size(), parallel.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_TRUE(expected[i] == parallel[i]);
+        }
+    }
+};
+
+#endif //MATRIX_MATRIX_TEST_FIXTURE_H
@@ -4,7 +4,11 @@
 #include "../src/compile_time_assert.h"
 #include "../src/num_theory_template_tricks.h"
 #include "../include/Finite.h"
+#include "../include/Rational.h"
+#include "../include/RationalAccumulator.h"
 #include "FiniteTestFixture.h"
+#include "BigIntegerTestFixture.h"
+#include "MatrixTestFixture.h"
 
 
 TEST_F(FiniteTestFixture, FiniteTest_Power_Test) {
@@ -65,6 +69,777 @@ TEST_F(FiniteTestFixture, FiniteTest_BasicOperations_Test) {
     testBasicOperations<1000000000>();
 }
 
+TEST_F(FiniteTestFixture, FiniteTest_Inverse_Test) {
+    for (unsigned a = 1; a < 10159; a += 97) {
+        Finite<10159> x(a);
+        Finite<10159> y(a * 31 + 7);
+        ASSERT_EQ((x * x.getInverse()).getValue(), 1u);
+        ASSERT_EQ((x.divideModulo(y) * y).getValue(), x.getValue());
+    }
+
+    // residues of moduli close to 2^32 stay below the modulus
+    Finite<4294967291u> big(4294967290u);
+    ASSERT_EQ((big * big).getValue(), 1u);
+    ASSERT_EQ((big + big).getValue(), 4294967289u);
+    ASSERT_EQ((Finite<4294967291u>(0) - big).getValue(), 1u);
+    ASSERT_EQ(big.getInverse().getValue(), 4294967290u);
+    ASSERT_EQ((Finite<4294967291u>(3) / Finite<4294967291u>(2) * Finite<4294967291u>(2)).getValue(), 3u);
+
+    // pow and the inverses are constant expressions
+    static_assert(Finite<10159>::pow(Finite<10159>(3), 10158) == Finite<10159>(1), "");
+    static_assert((Finite<1000000007>(2).getInverse() * Finite<1000000007>(2)).getValue() == 1, "");
+    static_assert(Finite<20400>(7).getInverse().getValue() == 8743, "");
+
+    // even moduli invert the units by the extended Euclidean algorithm
+    for (unsigned a = 1; a < 20400; a += 2) {
+        if (std::gcd(a, 20400u) == 1) {
+            Finite<20400> x(a);
+            ASSERT_EQ((x * x.getInverse()).getValue(), 1u);
+            ASSERT_EQ((Finite<20400>(a + 1) / x * x).getValue(), (a + 1) % 20400);
+        }
+    }
+
+    // batch inversion leaves zeros in place
+    std::vector<Finite<1000000007>> values, inverses;
+    std::vector<Finite<20400>> units;
+    for (unsigned a = 0; a < 1000; a++) {
+        values.emplace_back(a % 10 == 0 ? 0 : a * 999983);
+        if (std::gcd(a, 20400u) == 1) {
+            units.emplace_back(a);
+        }
+    }
+    inverses = values;
+    Finite<1000000007>::invertAll(inverses.data(), inverses.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(inverses[i], values[i].getValue() == 0 ? values[i] : values[i].getInverse());
+    }
+    std::vector<Finite<20400>> unitInverses = units;
+    Finite<20400>::invertAll(unitInverses.data(), unitInverses.size());
+    for (size_t i = 0; i < units.size(); i++) {
+        ASSERT_EQ((units[i] * unitInverses[i]).getValue(), 1u);
+    }
+    Finite<1000000007>::invertAll(nullptr, 0);
+
+    ModulusContext context(20400);
+    ModulusContext::Scope scope(&context);
+    std::vector<DynamicFinite> dynamic;
+    for (const Finite<20400> &x : units) {
+        dynamic.emplace_back(x.getValue());
+    }
+    dynamic.emplace_back(0);
+    DynamicFinite::invertAll(dynamic.data(), dynamic.size());
+    for (size_t i = 0; i < units.size(); i++) {
+        ASSERT_EQ(dynamic[i].getValue(), unitInverses[i].getValue());
+    }
+    ASSERT_EQ(dynamic.back().getValue(), 0u);
+}
+
+TEST_F(FiniteTestFixture, FiniteTest_Primality_Test) {
+    static_assert(IS_PRIME(2) && IS_PRIME(10159) && IS_PRIME(1000000007) && IS_PRIME(4294967291u), "");
+    static_assert(!IS_PRIME(0) && !IS_PRIME(1) && !IS_PRIME(561) && !IS_PRIME(4294967295u), "");
+    static_assert(IS_PRIME(18446744073709551557ull) && !IS_PRIME(18446744073709551615ull), "");
+
+    std::vector<unsigned> sieved = findPrimesOnSegment(100000);
+    for (unsigned n = 0; n < 100000; n++) {
+        ASSERT_EQ(millerRabin(n), std::binary_search(sieved.begin(), sieved.end(), n));
+    }
+    for (unsigned p : primeNumbers) {
+        ASSERT_TRUE(millerRabin(p));
+    }
+    for (unsigned c : compositeNumbers) {
+        ASSERT_FALSE(millerRabin(c));
+    }
+
+    // strong pseudoprimes to the first bases, a product of two primes near 2^32 and a prime square
+    ASSERT_FALSE(millerRabin(2047));
+    ASSERT_FALSE(millerRabin(3215031751u));
+    ASSERT_FALSE(millerRabin(4759123141ull));
+    ASSERT_FALSE(millerRabin(3825123056546413051ull));
+    ASSERT_FALSE(millerRabin(4294967291ull * 4294967279ull));
+    ASSERT_FALSE(millerRabin(4294967291ull * 4294967291ull));
+    ASSERT_TRUE(millerRabin(4294967311ull));
+    ASSERT_TRUE(millerRabin(1000000000000000003ull));
+
+    // the wheel search and the pre-sieved batches find the same primes, also across 2^32
+    for (uint64_t n : {0ull, 1ull, 2ull, 6ull, 7ull, 29ull, 30ull, 4000ull, 1000000000ull, 4294967000ull,
+                       1000000000000000000ull}) {
+        std::vector<uint64_t> batch = findNextPrimes(n, 300);
+        ASSERT_EQ(batch.size(), 300u);
+        uint64_t p = n;
+        for (uint64_t q : batch) {
+            p = findNextPrime(p);
+            ASSERT_EQ(q, p);
+        }
+    }
+    ASSERT_EQ(findNextPrime(4294967291u), 4294967311ull);
+    ASSERT_EQ(findNextPrimes(1u << 12, 5000).back(), findPrimesOnSegment(1u << 20)[564 + 4999]);
+    ASSERT_TRUE(findNextPrimes(100, 0).empty());
+}
+
+TEST_F(FiniteTestFixture, FiniteTest_Sieve_Test) {
+    ASSERT_EQ(countPrimesInRange(0, 1000000), 78498u);
+    ASSERT_EQ(countPrimesInRange(0, 10000000), 664579u);
+    ASSERT_EQ(primesInRange(0, 30), std::vector<uint64_t>({2, 3, 5, 7, 11, 13, 17, 19, 23, 29}));
+    ASSERT_EQ(primesInRange(2, 2), std::vector<uint64_t>({2}));
+    ASSERT_TRUE(primesInRange(0, 1).empty());
+    ASSERT_TRUE(primesInRange(24, 28).empty());
+    ASSERT_TRUE(primesInRange(100, 10).empty());
+    ASSERT_EQ(countPrimesInRange(7, 7), 1u);
+
+    // windows far from zero agree with the prime search, with tiny segments, sequentially and on several threads
+    ThreadPool &pool = ThreadPool::instance();
+    size_t threads = pool.threadCount();
+    size_t segmentBits = PrimeSieve::segmentBits;
+    for (size_t bits : {size_t(64), size_t(200), segmentBits}) {
+        PrimeSieve::segmentBits = bits;
+        for (size_t threadCount : {size_t(0), size_t(1), size_t(3)}) {
+            // 0 is the sequential mode
+            bool parallel = threadCount != 0;
+            pool.setThreadCount(std::max(threadCount, size_t(1)));
+            for (uint64_t lo : {0ull, 1000000000ull, 4294960000ull, 1000000000000ull}) {
+                std::vector<uint64_t> primes = primesInRange(lo, lo + 20000, parallel);
+                std::vector<uint64_t> expected = findNextPrimes(lo == 0 ? 0 : lo - 1, primes.size() + 1);
+                ASSERT_GT(expected.back(), lo + 20000);
+                expected.pop_back();
+                ASSERT_EQ(primes, expected);
+                ASSERT_EQ(countPrimesInRange(lo, lo + 20000, parallel), primes.size());
+            }
+        }
+    }
+    PrimeSieve::segmentBits = segmentBits;
+    pool.setThreadCount(threads);
+}
+
+TEST_F(FiniteTestFixture, FiniteTest_Kernels_Test) {
+    testKernels<1000000007>();
+    testKernels<998244353>();
+    testKernels<4294967291u>();
+    testKernels<3>();
+    testKernels<1000000000>();
+    testKernels<2083881914>();
+    testKernels<6>();
+}
+
+TEST_F(FiniteTestFixture, FiniteTest_Dynamic_Test) {
+    testDynamic<1000000007>();
+    testDynamic<10159>();
+    testDynamic<4294967291u>();
+    testDynamic<3>();
+    testDynamic<1000000000>();
+    testDynamic<2083881914>();
+    testDynamic<4294967294u>();
+    testDynamic<6>();
+
+    // elements belong to the innermost scope
+    ModulusContext outer(7), inner(11);
+    ModulusContext::Scope outerScope(&outer);
+    DynamicFinite x(10);
+    {
+        ModulusContext::Scope innerScope(&inner);
+        ASSERT_EQ(DynamicFinite(10).getInverse().getValue(), 10u);
+    }
+    ASSERT_EQ(x.getInverse().getValue(), 5u);
+}
+
+TEST_F(FiniteTestFixture, FiniteTest_Finite64_Test) {
+    testFinite64<3>();
+    testFinite64<1000000007>();
+    testFinite64<4294967311ull>();
+    testFinite64<(1ull << 61) - 1>();
+    testFinite64<4611686018427387847ull>();
+    testFinite64<18446744073709551557ull>();
+
+    // odd composite moduli
+    testFinite64<4294967297ull>();
+    testFinite64<18446744073709551615ull>();
+
+    // the same residues as Finite<M>
+    std::mt19937 rnd;
+    for (size_t i = 0; i < 1000; i++) {
+        unsigned a = rnd(), b = rnd();
+        ASSERT_EQ((Finite64<1000000007>(a) * Finite64<1000000007>(b)).getValue(),
+                  (Finite<1000000007>(a) * Finite<1000000007>(b)).getValue());
+        ASSERT_EQ(Finite64<1000000007>(a).getInverse().getValue(), Finite<1000000007>(a).getInverse().getValue());
+    }
+
+    static_assert((Finite64<18446744073709551557ull>(2).getInverse() * Finite64<18446744073709551557ull>(2))
+                          .getValue() == 1, "");
+
+    std::vector<Finite64<18446744073709551557ull>> values, inverses;
+    for (unsigned a = 0; a < 100; a++) {
+        values.emplace_back(a % 10 == 0 ? 0 : (uint64_t) rnd() << 32 | rnd());
+    }
+    inverses = values;
+    Finite64<18446744073709551557ull>::invertAll(inverses.data(), inverses.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(inverses[i], values[i].getValue() == 0 ? values[i] : values[i].getInverse());
+    }
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_Representation_Test) {
+
+    // limbs are binary
+    BigInteger twoPow32("4294967296");
+    ASSERT_EQ(twoPow32.length(), 2u);
+    ASSERT_EQ(twoPow32[0], 0u);
+    ASSERT_EQ(twoPow32[1], 1u);
+    ASSERT_EQ(BigInteger("4294967295").length(), 1u);
+    ASSERT_EQ(BigInteger("-18446744073709551616").toString(), "-18446744073709551616");
+
+    ASSERT_EQ(BigInteger("0").toString(), "0");
+    ASSERT_EQ(BigInteger("-0").toString(), "0");
+    ASSERT_EQ(BigInteger("000123").toString(), "123");
+    ASSERT_EQ(BigInteger(-2147483647 - 1).toString(), "-2147483648");
+    ASSERT_EQ(BigInteger(INT64_MIN).toString(), "-9223372036854775808");
+    ASSERT_EQ(BigInteger(UINT64_MAX).toString(), "18446744073709551615");
+    ASSERT_EQ(BigInteger(0u), BigInteger("0"));
+
+    // values crossing the inline capacity of LimbVector
+    BigInteger a(UINT64_MAX);
+    for (int t = 0; t < 6; t++) {
+        BigInteger b = a;
+        a *= a;
+        BigInteger c = std::move(b);
+        ASSERT_EQ(a / c, c);
+    }
+
+    for (int t = 0; t < 200; t++) {
+        BigInteger a = randomBigInteger(1 + rnd() % 300);
+        BigInteger b = randomBigInteger(1 + rnd() % 300);
+        ASSERT_EQ(BigInteger(a.toString()), a);
+        ASSERT_EQ((a + b) - b, a);
+        ASSERT_EQ(a - a, BigInteger(0));
+        ASSERT_EQ(a < b, b - a > BigInteger(0));
+        ASSERT_EQ(a < b, !(a >= b));
+    }
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_DecimalConversion_Test) {
+
+    for (size_t splitThreshold : {1, 3, 10}) {
+        for (int t = 0; t < 30; t++) {
+            checkDecimalConversion(randomBigInteger(1 + rnd() % 3000).toString(), splitThreshold);
+        }
+
+        // powers of ten and their neighbours are the boundaries of the split
+        for (size_t digits : {9, 18, 36, 72, 144, 288, 576, 1152}) {
+            checkDecimalConversion("1" + std::string(digits, '0'), splitThreshold);
+            checkDecimalConversion("-" + std::string(digits, '9'), splitThreshold);
+            checkDecimalConversion("1" + std::string(digits - 1, '0') + "1", splitThreshold);
+            checkDecimalConversion(std::string(digits / 2, '0') + "1" + std::string(digits, '0'), splitThreshold);
+        }
+    }
+
+    ASSERT_EQ(BigInteger("+15").toString(), "15");
+    ASSERT_EQ((BigInteger(1) << 100).toString(), "1267650600228229401496703205376");
+    ASSERT_EQ((BigInteger("1267650600228229401496703205377") >> 100).toString(), "1");
+    ASSERT_EQ((BigInteger(-5) >> 1).toString(), "-2");
+    ASSERT_EQ((BigInteger(1) << 100).bitLength(), 101u);
+    ASSERT_EQ(BigInteger(0).bitLength(), 0u);
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_Multiplication_Test) {
+
+    // schoolbook only
+    testMultiplication(SIZE_MAX, SIZE_MAX, SIZE_MAX, 500);
+
+    // karatsuba with a tiny base case
+    testMultiplication(2, SIZE_MAX, SIZE_MAX, 2000);
+
+    // toom-3 on top of karatsuba
+    testMultiplication(2, 6, SIZE_MAX, 3000);
+    testMultiplication(4, 9, SIZE_MAX, 5000);
+
+    // number-theoretic transform
+    testMultiplication(SIZE_MAX, SIZE_MAX, 1, 5000);
+    testMultiplication(4, 9, 30, 20000);
+
+    // unbalanced operands
+    for (int t = 0; t < 20; t++) {
+        BigInteger a = randomBigInteger(20000);
+        BigInteger b = randomBigInteger(1 + rnd() % 3000);
+        ASSERT_EQ(a * b, referenceProduct(a, b));
+    }
+
+    // (10^n - 1)^2 = 99..9800..01, all limbs are base - 1, which is the worst case for the NTT
+    LimbArithmetic::nttThreshold = 1;
+    BigInteger nines(std::string(90000, '9'));
+    ASSERT_EQ((nines * nines).toString(), std::string(89999, '9') + "8" + std::string(89999, '0') + "1");
+    ASSERT_EQ(nines * BigInteger(0), BigInteger(0));
+    ASSERT_EQ((-nines) * nines, -(nines * nines));
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_Division_Test) {
+
+    // single limb divisors
+    testDivision(200, 9);
+
+    // multi-limb divisors
+    testDivision(50, 30);
+    testDivision(2000, 1000);
+
+    ASSERT_EQ(BigInteger(7) / BigInteger(-3), BigInteger(-2));
+    ASSERT_EQ(BigInteger(7) % BigInteger(-3), BigInteger(1));
+    ASSERT_EQ(BigInteger(-7) / BigInteger(-3), BigInteger(2));
+    ASSERT_EQ(BigInteger(-7) % BigInteger(-3), BigInteger(-1));
+    ASSERT_EQ(BigInteger(5) / BigInteger(6), BigInteger(0));
+
+    // limbs equal to base - 1 and divisors with a small top limb force the quotient estimate corrections
+    BigInteger nines(std::string(200, '9'));
+    for (int digits = 10; digits < 150; digits += 7) {
+        checkDivision(nines, BigInteger("1" + std::string(digits, '0') + "1"));
+        checkDivision(nines, BigInteger(std::string(digits, '9')));
+        checkDivision(nines * nines, BigInteger("5" + std::string(digits, '0')));
+    }
+
+    for (int t = 0; t < 300; t++) {
+        BigInteger q = randomBigInteger(1 + rnd() % 300);
+        BigInteger b = randomBigInteger(1 + rnd() % 300);
+        if (b == 0) {
+            continue;
+        }
+        checkExactDivision(q, b);
+        // Divisors with zero limbs and bits at the bottom
+        checkExactDivision(q, b << (rnd() % 200));
+        checkExactDivision(q, BigInteger(1) << (rnd() % 200));
+    }
+    checkExactDivision(BigInteger(0), BigInteger(-3));
+    checkExactDivision(BigInteger(-1), BigInteger(-1));
+    checkExactDivision(nines, nines * nines);
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_InPlace_Test) {
+    for (int t = 0; t < 300; t++) {
+        BigInteger a = randomBigInteger(1 + rnd() % 60);
+        BigInteger b = randomBigInteger(1 + rnd() % 60);
+        BigInteger c = t % 3 == 0 ? BigInteger(int(rnd() % 1000) - 500) : randomBigInteger(1 + rnd() % 60);
+
+        BigInteger sum = a;
+        sum += b;
+        ASSERT_EQ(sum, a + b);
+        BigInteger difference = a;
+        difference -= b;
+        ASSERT_EQ(difference, a - b);
+
+        ASSERT_EQ(BigInteger(a) + b, a + b);
+        ASSERT_EQ(a + BigInteger(b), a + b);
+        ASSERT_EQ(BigInteger(a) - b, a - b);
+        ASSERT_EQ(a - BigInteger(b), a - b);
+        ASSERT_EQ(BigInteger(a) - BigInteger(b), a - b);
+        ASSERT_EQ(-BigInteger(a), -a);
+        ASSERT_EQ(abs(BigInteger(a)), abs(a));
+
+        BigInteger accumulator = a;
+        addmul(accumulator, b, c);
+        ASSERT_EQ(accumulator, a + b * c);
+        submul(accumulator, b, c);
+        ASSERT_EQ(accumulator, a);
+    }
+
+    // operands aliasing the result
+    BigInteger a = randomBigInteger(40);
+    BigInteger doubled = a + a;
+    BigInteger b = a;
+    b += b;
+    ASSERT_EQ(b, doubled);
+    b -= b;
+    ASSERT_EQ(b, 0);
+    ASSERT_EQ(b.getSign(), 1);
+    b = a;
+    addmul(b, b, BigInteger(3));
+    ASSERT_EQ(b, a * 4);
+    b = BigInteger(3);
+    addmul(b, a, b);
+    ASSERT_EQ(b, a * 3 + 3);
+
+    // carries through the whole number and cancellation to zero
+    BigInteger nines(std::string(100, '9'));
+    nines += 1;
+    ASSERT_EQ(nines, BigInteger("1" + std::string(100, '0')));
+    nines -= BigInteger("1" + std::string(100, '0'));
+    ASSERT_EQ(nines, 0);
+    ASSERT_EQ(-nines, 0);
+    ASSERT_EQ((-std::move(nines)).getSign(), 1);
+}
+
+TEST_F(BigIntegerTestFixture, BigIntegerTest_Gcd_Test) {
+    ASSERT_EQ(gcd(BigInteger(0), BigInteger(0)), 0);
+    ASSERT_EQ(gcd(BigInteger(0), BigInteger(-12)), 12);
+    ASSERT_EQ(gcd(BigInteger(-18), BigInteger(12)), 6);
+    ASSERT_EQ(gcd(BigInteger(1) << 200, BigInteger(3) << 100), BigInteger(1) << 100);
+
+    for (int t = 0; t < 300; t++) {
+        BigInteger common = randomBigInteger(1 + rnd() % 100);
+        BigInteger a = randomBigInteger(1 + rnd() % 200) * common;
+        BigInteger b = randomBigInteger(1 + rnd() % 200) * common;
+        checkGcd(a, b);
+        checkGcd(a, a + 1);
+        checkGcd(a, randomBigInteger(1 + rnd() % 19));
+    }
+
+    // consecutive Fibonacci numbers give the longest quotient sequence of ones
+    BigInteger previous(0);
+    BigInteger current(1);
+    for (int i = 0; i < 3000; i++) {
+        previous += current;
+        std::swap(previous, current);
+    }
+    ASSERT_EQ(gcd(current, previous), 1);
+    ASSERT_EQ(gcd(current * 12345, previous * 12345), 12345);
+
+    ASSERT_EQ(Rational(BigInteger(6), BigInteger(-4)).toString(), "-3/2");
+    ASSERT_EQ(Rational(BigInteger(0), BigInteger(-4)).toString(), "0");
+}
+
+TEST_F(BigIntegerTestFixture, RationalTest_Arithmetic_Test) {
+    for (int t = 0; t < 500; t++) {
+        // small shared factors make the cancellations non-trivial
+        BigInteger factor = randomBigInteger(1 + rnd() % 3, false);
+        BigInteger na = randomBigInteger(1 + rnd() % 30) * (t % 2 ? factor : 1);
+        BigInteger da = t % 5 == 0 ? BigInteger(1) : randomBigInteger(1 + rnd() % 30) * factor;
+        BigInteger nb = t % 7 == 0 ? BigInteger(0) : randomBigInteger(1 + rnd() % 30) * factor;
+        BigInteger db = t % 3 == 0 ? BigInteger(1) : randomBigInteger(1 + rnd() % 30) * (t % 4 ? factor : 1);
+        Rational a(na, da);
+        Rational b(nb, db);
+
+        ASSERT_EQ((a + b).toString(), Rational(na * db + da * nb, da * db).toString());
+        ASSERT_EQ((a - b).toString(), Rational(na * db - da * nb, da * db).toString());
+        ASSERT_EQ((a * b).toString(), Rational(na * nb, da * db).toString());
+        if (nb != 0) {
+            ASSERT_EQ((a / b).toString(), Rational(na * db, da * nb).toString());
+        }
+        ASSERT_EQ((a - a).toString(), "0");
+
+        Rational c = a;
+        c += c;
+        ASSERT_EQ(c.toString(), (a * 2).toString());
+        c *= c;
+        ASSERT_EQ(c.toString(), (a * a * 4).toString());
+        if (na != 0) {
+            c /= c;
+            ASSERT_EQ(c.toString(), "1");
+        }
+    }
+
+    ASSERT_EQ((Rational(BigInteger(1), BigInteger(6)) + Rational(BigInteger(1), BigInteger(3))).toString(), "1/2");
+    ASSERT_EQ((Rational(BigInteger(3), BigInteger(4)) / Rational(BigInteger(-9), BigInteger(8))).toString(), "-2/3");
+    ASSERT_EQ((Rational(7) * Rational(-3)).toString(), "-21");
+}
+
+TEST_F(BigIntegerTestFixture, RationalTest_Comparison_Test) {
+    for (int t = 0; t < 1000; t++) {
+        BigInteger na = randomBigInteger(1 + rnd() % 25);
+        BigInteger da = t % 5 == 0 ? BigInteger(1) : randomBigInteger(1 + rnd() % 25, false);
+        BigInteger nb, db;
+        switch (t % 4) {
+            case 0:
+                // the same value in other terms
+                nb = na * 3;
+                db = da * 3;
+                break;
+            case 1:
+                // the same integer part
+                nb = na + (t % 8 == 1 ? 1 : -1);
+                db = da;
+                break;
+            case 2:
+                // close values with different denominators
+                nb = na * da + 1;
+                db = da * da;
+                break;
+            default:
+                nb = randomBigInteger(1 + rnd() % 25);
+                db = randomBigInteger(1 + rnd() % 25, false);
+        }
+        Rational a(na, da);
+        Rational b(nb, db);
+
+        BigInteger difference = na * db - nb * da;
+        int expected = difference == 0 ? 0 : difference.getSign();
+        ASSERT_EQ(compare(a, b), expected);
+        ASSERT_EQ(compare(b, a), -expected);
+        ASSERT_EQ(a == b, expected == 0);
+        ASSERT_EQ(a != b, expected != 0);
+        ASSERT_EQ(a < b, expected < 0);
+        ASSERT_EQ(a > b, expected > 0);
+        ASSERT_EQ(a <= b, expected <= 0);
+        ASSERT_EQ(a >= b, expected >= 0);
+    }
+
+    ASSERT_TRUE(Rational(0) == Rational(BigInteger(0), BigInteger(-5)));
+    ASSERT_TRUE(Rational(BigInteger(-1), BigInteger(3)) < Rational(0));
+    ASSERT_TRUE(Rational(BigInteger(7), BigInteger(3)) > Rational(2));
+    ASSERT_TRUE(Rational(BigInteger(-7), BigInteger(3)) < Rational(BigInteger(-9), BigInteger(4)));
+}
+
+TEST_F(BigIntegerTestFixture, RationalTest_Conversion_Test) {
+    std::uniform_real_distribution<double> exponents(-1080, 1020);
+    for (int t = 0; t < 2000; t++) {
+        // every finite double is a binary fraction and must convert back exactly
+        double x = std::ldexp(std::uniform_real_distribution<double>(1, 2)(rnd), int(exponents(rnd)));
+        x = t % 2 ? x : -x;
+        int exponent;
+        double mantissa = std::frexp(x, &exponent);
+        BigInteger scaledMantissa(int64_t(std::ldexp(mantissa, 60)));
+        Rational q = exponent - 60 >= 0 ? Rational(scaledMantissa << size_t(exponent - 60))
+                                        : Rational(scaledMantissa, BigInteger(1) << size_t(60 - exponent));
+        ASSERT_EQ(double(q), x);
+
+        // IEEE division of exactly representable operands is correctly rounded as well
+        int64_t n = int64_t(rnd() % (uint64_t(1) << 53)) - int64_t(uint64_t(1) << 52);
+        int64_t d = 1 + int64_t(rnd() % (uint64_t(1) << 53));
+        ASSERT_EQ(double(Rational(BigInteger(n), BigInteger(d))), double(n) / double(d));
+        uint64_t ln = (uint64_t(rnd()) << 32) | rnd();
+        uint64_t ld = ((uint64_t(rnd()) << 32) | rnd()) | 1;
+        ASSERT_EQ((long double) Rational(BigInteger(ln), BigInteger(ld)), (long double) ln / (long double) ld);
+    }
+
+    double denormMin = std::numeric_limits<double>::denorm_min();
+    ASSERT_EQ(double(Rational(BigInteger(3), BigInteger(1) << 1076)), denormMin);
+    ASSERT_EQ(double(Rational(BigInteger(1), BigInteger(1) << 1075)), 0.0);
+    ASSERT_EQ(double(Rational(BigInteger(3), BigInteger(1) << 1075)), 2 * denormMin);
+    ASSERT_EQ(double(Rational(BigInteger(-1), BigInteger(1) << 5000)), 0.0);
+    ASSERT_EQ(double(Rational(BigInteger(1) << 1024)), std::numeric_limits<double>::infinity());
+    ASSERT_EQ(double(Rational(BigInteger(1) << 1023)), std::ldexp(1.0, 1023));
+    ASSERT_EQ(double(Rational(0)), 0.0);
+    ASSERT_EQ(double(Rational(BigInteger(1), BigInteger(3))), 1.0 / 3);
+
+    ASSERT_EQ(Rational(BigInteger(1), BigInteger(3)).asDecimal(5), "0.33333");
+    ASSERT_EQ(Rational(BigInteger(-22), BigInteger(7)).asDecimal(3), "-3.142");
+    ASSERT_EQ(Rational(BigInteger(-1), BigInteger(1000)).asDecimal(2), "0.00");
+    ASSERT_EQ(Rational(BigInteger(-1), BigInteger(1000)).asDecimal(3), "-0.001");
+    ASSERT_EQ(Rational(BigInteger(7), BigInteger(2)).asDecimal(), "3");
+    ASSERT_EQ(Rational(BigInteger(1), BigInteger(7)).asDecimal(40), "0.1428571428571428571428571428571428571428");
+}
+
+TEST_F(BigIntegerTestFixture, RationalTest_Accumulator_Test) {
+    size_t savedThreshold = RationalAccumulator::normalizeThreshold;
+    std::vector<Rational> terms;
+    for (int i = 0; i < 300; i++) {
+        BigInteger numerator = randomBigInteger(1 + rnd() % 12);
+        BigInteger denominator = i % 4 == 0 ? BigInteger(1) : randomBigInteger(1 + rnd() % 3, false);
+        terms.emplace_back(numerator, denominator);
+    }
+
+    for (size_t threshold : {size_t(0), size_t(4), SIZE_MAX}) {
+        RationalAccumulator::normalizeThreshold = threshold;
+        Rational expected;
+        Rational expectedDot;
+        RationalAccumulator sum;
+        RationalAccumulator dot;
+        for (size_t i = 0; i + 1 < terms.size(); i++) {
+            if (i % 3 == 0) {
+                expected -= terms[i];
+                sum -= terms[i];
+            } else {
+                expected += terms[i];
+                sum += terms[i];
+            }
+            expectedDot += terms[i] * terms[i + 1];
+            addmul(dot, terms[i], terms[i + 1]);
+        }
+        const RationalAccumulator &constSum = sum;
+        ASSERT_EQ(constSum.value(), expected);
+        ASSERT_EQ(constSum.toString(), expected.toString());
+        ASSERT_EQ(dot.value(), expectedDot);
+
+        sum += sum;
+        ASSERT_EQ(sum.value(), expected * 2);
+        sum -= RationalAccumulator(expected * 2);
+        ASSERT_EQ(sum.toString(), "0");
+        submul(dot, terms[0], terms[1]);
+        ASSERT_EQ(dot.value(), expectedDot - terms[0] * terms[1]);
+    }
+    RationalAccumulator::normalizeThreshold = savedThreshold;
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_Multiplication_Test) {
+    checkProduct<Finite<10159>, 1, 1, 1>();
+    checkProduct<Finite<10159>, 17, 9, 23>();
+    checkProduct<Finite<10159>, 64, 64, 64>();
+    checkProduct<Finite<10159>, 37, 30, 41>();
+    checkProduct<Finite<20400>, 13, 31, 11>();
+    checkProduct<double, 19, 33, 8>();
+    checkProduct<Rational, 7, 12, 5>();
+
+    Matrix<2, 3, Finite<10159>> a = {{Finite<10159>(1), Finite<10159>(2), Finite<10159>(3)},
+                                     {Finite<10159>(4), Finite<10159>(5), Finite<10159>(6)}};
+    Matrix<3, 2, Finite<10159>> b = a.transposed();
+    Matrix<2, 2, Finite<10159>> product = a * b;
+    ASSERT_EQ(product[0][0].getValue(), 14u);
+    ASSERT_EQ(product[0][1].getValue(), 32u);
+    ASSERT_EQ(product[1][1].getValue(), 77u);
+    ASSERT_EQ(product.trace().getValue(), 91u);
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_Elimination_Test) {
+    checkElimination<Finite<10159>, 1>();
+    checkElimination<Finite<10159>, 10>();
+    checkElimination<Finite<10159>, 40>();
+    checkElimination<Finite64<4611686018427387847ull>, 30>();
+    checkElimination<Rational, 10>();
+
+    SquareMatrix<3, double> a = {{0, 2, 1}, {1, 1, 1}, {2, 1, 0}};
+    ASSERT_DOUBLE_EQ(a.det(), 3);
+    SquareMatrix<3, double> inverse = a.inverted();
+    SquareMatrix<3, double> identity = a * inverse;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            ASSERT_NEAR(identity[i][j], i == j ? 1 : 0, 1e-12);
+        }
+    }
+
+    Matrix<2, 4, Rational> wide = {{1, 2, 3, 4}, {2, 4, 6, 8}};
+    ASSERT_EQ(wide.rank(), 1u);
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_FractionFree_Test) {
+    checkFractionFree<1, 1>(1, 2, 10);
+    checkFractionFree<12, 12>(12, 1000, 100);
+    checkFractionFree<12, 12>(7, 1000, 30);
+    checkFractionFree<15, 15>(15, 4, 60);
+    checkFractionFree<9, 14>(9, 3, 200);
+    checkFractionFree<14, 9>(6, 5, 5);
+
+    SquareMatrix<3, BigInteger> a = {{0, 2, 1}, {1, 1, 1}, {2, 1, 0}};
+    ASSERT_EQ(a.det(), BigInteger(3));
+    SquareMatrix<3, BigInteger> echelon = a.echelonForm();
+    ASSERT_EQ(echelon[2][2], BigInteger(-3));
+
+    SquareMatrix<4, BigInteger> vandermonde;
+    for (size_t i = 0; i < 4; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            vandermonde[i][j] = BigInteger(int(std::pow(i + 2, j)));
+        }
+    }
+    // prod (x_j - x_i) over i < j for x = 2, 3, 4, 5
+    ASSERT_EQ(vandermonde.det(), BigInteger(12));
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_MultiModular_Test) {
+    checkMultiModular<1>(1, 10);
+    checkMultiModular<2>(2, 200);
+    checkMultiModular<8>(8, 40);
+    checkMultiModular<8>(5, 40);
+    checkMultiModular<20>(20, 100);
+    checkMultiModular<20>(19, 3);
+    checkMultiModular<33>(33, 1);
+
+    // a right side far longer than a, Cramer's numerators are much longer than the denominators
+    SquareMatrix<8, BigInteger> small = randomIntegerMatrix<8>(8, 3);
+    Matrix<8, 1, BigInteger> large;
+    for (size_t i = 0; i < 8; i++) {
+        large[i][0] = (BigInteger(int(rnd() % 2001) - 1000) << 4000) + BigInteger(int(rnd()));
+    }
+    Matrix<8, 1, Rational> y;
+    ASSERT_TRUE(solve(small, large, y));
+    for (size_t i = 0; i < 8; i++) {
+        Rational sum(0);
+        for (size_t j = 0; j < 8; j++) {
+            sum += Rational(small[i][j]) * y[j][0];
+        }
+        ASSERT_EQ(sum, Rational(large[i][0]));
+    }
+
+    Rational q;
+    BigInteger m = BigInteger(1000003) * BigInteger(1000033);
+    // u = -7 / 12 modulo m is (k * m - 7) / 12 for the k making it an integer
+    for (int k = 1; k <= 12; k++) {
+        BigInteger numerator = BigInteger(k) * m - BigInteger(7);
+        if (numerator % BigInteger(12) == 0) {
+            ASSERT_TRUE(MultiModular::reconstructRational(numerator / BigInteger(12), m, q));
+            ASSERT_EQ(q, Rational(BigInteger(-7), BigInteger(12)));
+        }
+    }
+    ASSERT_FALSE(MultiModular::reconstructRational(BigInteger(1000003) * BigInteger(500), m, q));
+    ASSERT_TRUE(MultiModular::reconstructRational(BigInteger(0), m, q));
+    ASSERT_EQ(q, Rational(0));
+    ASSERT_TRUE(MultiModular::reconstructRational(m - BigInteger(5), m, q));
+    ASSERT_EQ(q, Rational(-5));
+
+    // The pool runs the primes, results do not depend on the number of threads
+    ThreadPool &pool = ThreadPool::instance();
+    size_t threads = pool.threadCount();
+    pool.setThreadCount(3);
+    checkMultiModular<12>(12, 60);
+    pool.setThreadCount(threads);
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_Parallel_Test) {
+    ThreadPool pool(4);
+    ASSERT_EQ(pool.threadCount(), 4u);
+
+    std::vector<int> visits(10000);
+    pool.parallelFor(0, visits.size(), 7, [&](size_t lo, size_t hi) {
+        // Nested loops are run by the waiting threads
+        pool.parallelFor(lo, hi, 1, [&](size_t nestedLo, size_t nestedHi) {
+            for (size_t i = nestedLo; i < nestedHi; i++) {
+                visits[i]++;
+            }
+        });
+    });
+    ASSERT_EQ(std::count(visits.begin(), visits.end(), 1), 10000);
+
+    ASSERT_THROW(pool.parallelFor(0, 100, 1, [](size_t lo, size_t) {
+        if (lo > 50) {
+            throw std::runtime_error("chunk failed");
+        }
+    }), std::runtime_error);
+
+    checkThreadCountIndependence<Finite<10159>, 45>();
+    checkThreadCountIndependence<Finite<71>, 23>();
+    checkThreadCountIndependence<double, 37>();
+    checkThreadCountIndependence<Rational, 9>();
+
+    // the modulus context is carried into the tasks
+    ModulusContext context(1000000007);
+    ModulusContext::Scope scope(&context);
+    checkThreadCountIndependence<DynamicFinite, 45>();
+}
+
+TEST_F(MatrixTestFixture, MatrixTest_DynamicFinite_Test) {
+    {
+        ModulusContext context(1000000007);
+        ModulusContext::Scope scope(&context);
+        checkProduct<DynamicFinite, 37, 30, 41>();
+        checkProduct<DynamicFinite, 64, 64, 64>();
+        checkElimination<DynamicFinite, 40>();
+    }
+
+    // the same matrices as over Finite<M> with the modulus as a template argument
+    Matrix<30, 30, Finite<10159>> a = randomMatrix<30, 30, Finite<10159>>();
+    Matrix<30, 30, Finite<20400>> b = randomMatrix<30, 30, Finite<20400>>();
+    ModulusContext prime(10159), even(20400);
+    {
+        ModulusContext::Scope scope(&prime);
+        Matrix<30, 30, DynamicFinite> x;
+        for (size_t i = 0; i < 30; i++) {
+            for (size_t j = 0; j < 30; j++) {
+                x[i][j] = DynamicFinite(a[i][j].getValue());
+            }
+        }
+        ASSERT_EQ(x.det().getValue(), a.det().getValue());
+        ASSERT_EQ((x * x).trace().getValue(), (a * a).trace().getValue());
+        ASSERT_EQ(x.inverted()[3][7].getValue(), a.inverted()[3][7].getValue());
+    }
+    {
+        ModulusContext::Scope scope(&even);
+        Matrix<30, 30, DynamicFinite> y;
+        for (size_t i = 0; i < 30; i++) {
+            for (size_t j = 0; j < 30; j++) {
+                y[i][j] = DynamicFinite(b[i][j].getValue());
+            }
+        }
+        Matrix<30, 30, DynamicFinite> product = y * y - y;
+        Matrix<30, 30, Finite<20400>> expected = b * b - b;
+        for (size_t i = 0; i < 30; i++) {
+            for (size_t j = 0; j < 30; j++) {
+                ASSERT_EQ(product[i][j].getValue(), expected[i][j].getValue());
+            }
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();